@@ -150,7 +150,11 @@ namespace Elite
 			if (clickedIdx != invalid_node_index && m_SelectedNodeIdx != clickedIdx)
 			{
 				if(IsUniqueConnection(m_SelectedNodeIdx, clickedIdx))
-					AddConnection(new GraphConnection2D(m_SelectedNodeIdx, clickedIdx));
+				{
+					T_ConnectionType* pConnection = CreateConnection(m_SelectedNodeIdx, clickedIdx);
+					if (!AddConnection(pConnection))
+						DeleteConnection(pConnection);
+				}
 			}
 
 			m_SelectedNodeIdx = invalid_node_index;
@@ -161,7 +165,7 @@ namespace Elite
 		}
 		else
 		{
-			AddNode(new T_NodeType(GetNextFreeNodeIndex(), mousePos));
+			AddNode(CreateNode(GetNextFreeNodeIndex(), mousePos));
 		}
 	}
 
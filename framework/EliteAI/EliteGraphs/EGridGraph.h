@@ -9,6 +9,7 @@
 #include "EIGraph.h"
 #include "EGraphConnectionTypes.h"
 #include "EGraphNodeTypes.h"
+#include "framework/EliteHelpers/EThreadPool.h"
 
 namespace Elite
 {
@@ -17,8 +18,9 @@ namespace Elite
 	{
 	public:
 		GridGraph(bool isDirectional);
-		GridGraph(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5);
-		void InitializeGrid(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5);
+		GridGraph(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5, EThreadPool* pThreadPool = nullptr);
+		// Builds the whole grid as one bulk build, with a thread pool the connection lists are filled per row in parallel
+		void InitializeGrid(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5, EThreadPool* pThreadPool = nullptr);
 
 		using IGraph::GetNode;
 		T_NodeType* GetNode(int col, int row) const { return m_Nodes[GetIndex(col, row)]; }
@@ -59,6 +61,8 @@ namespace Elite
 
 		// graph creation helper functions
 		void AddConnectionsInDirections(int idx, int col, int row, vector<Vector2> directions);
+		void AddAllConnections(EThreadPool* pThreadPool);
+		void CreateCellConnections(int idx, vector<T_ConnectionType*>& connections);
 
 		float CalculateConnectionCost(int fromIdx, int toIdx) const;
 	
@@ -85,7 +89,8 @@ namespace Elite
 		bool isDirectionalGraph, 
 		bool isConnectedDiagonally, 
 		float costStraight /* = 1.f*/, 
-		float costDiagonal /* = 1.5f */)
+		float costDiagonal /* = 1.5f */,
+		EThreadPool* pThreadPool /* = nullptr */)
 		: IGraph(isDirectionalGraph)
 		, m_NrOfColumns(columns)
 		, m_NrOfRows(rows)
@@ -94,7 +99,7 @@ namespace Elite
 		, m_DefaultCostStraight(costStraight)
 		, m_DefaultCostDiagonal(costDiagonal)
 	{
-		InitializeGrid(columns, rows, cellSize, isDirectionalGraph, isConnectedDiagonally, costStraight, costDiagonal);
+		InitializeGrid(columns, rows, cellSize, isDirectionalGraph, isConnectedDiagonally, costStraight, costDiagonal, pThreadPool);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -105,7 +110,8 @@ namespace Elite
 		bool isDirectionalGraph,
 		bool isConnectedDiagonally, 
 		float costStraight /* = 1.f*/,
-		float costDiagonal /* = 1.5f */)
+		float costDiagonal /* = 1.5f */,
+		EThreadPool* pThreadPool /* = nullptr */)
 	{
 		m_IsDirectionalGraph = isDirectionalGraph;
 		m_NrOfColumns = columns;
@@ -115,24 +121,24 @@ namespace Elite
 		m_DefaultCostStraight = costStraight;
 		m_DefaultCostDiagonal = costDiagonal;
 
+		// Reserve storage for all nodes and connections up front, a cell has at most 4 or 8 neighbours
+		const int nrOfCells = m_NrOfColumns * m_NrOfRows;
+		BeginBulkBuild(nrOfCells, nrOfCells * (m_IsConnectedDiagonally ? 8 : 4));
+
 		// Create all nodes
 		for (auto r = 0; r < m_NrOfRows; ++r)
 		{
 			for (auto c = 0; c < m_NrOfColumns; ++c)
 			{
 				int idx = GetIndex(c, r);
-				AddNode(new T_NodeType(idx));
+				AddNode(CreateNode(idx));
 			}
 		}
 
 		// Create connections in each valid direction on each node
-		for (auto r = 0; r < m_NrOfRows; ++r)
-		{
-			for (auto c = 0; c < m_NrOfColumns; ++c)
-			{
-				AddConnectionsToAdjacentCells(c, r);
-			}
-		}
+		AddAllConnections(pThreadPool);
+
+		EndBulkBuild();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -155,7 +161,7 @@ namespace Elite
 			AddConnectionsInDirections(idx, col, row, m_DiagonalDirections);
 		}
 
-		OnGraphModified(false, true);
+		NotifyGraphModified(false, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -180,8 +186,103 @@ namespace Elite
 
 				if (IsUniqueConnection(idx, neighborIdx) 
 					&& connectionCost < 100000) //Extra check for different terrain types
-					AddConnection(new GraphConnection(idx, neighborIdx, connectionCost));
+				{
+					T_ConnectionType* pConnection = CreateConnection(idx, neighborIdx, connectionCost);
+					if (!AddConnection(pConnection))
+						DeleteConnection(pConnection);
+				}
+			}
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	void GridGraph<T_NodeType, T_ConnectionType>::AddAllConnections(EThreadPool* pThreadPool)
+	{
+		// Every cell gets the connections AddConnectionsToAdjacentCells on each cell would give it, in the same order.
+		// The graph's pool is single threaded, so all connection objects are made first.
+		const int nrOfCells = m_NrOfColumns * m_NrOfRows;
+		vector<int> offsets(nrOfCells + 1, 0);
+		vector<T_ConnectionType*> connections{};
+		connections.reserve(size_t(nrOfCells) * (m_IsConnectedDiagonally ? 8 : 4));
+
+		for (int idx = 0; idx < nrOfCells; ++idx)
+		{
+			offsets[idx] = int(connections.size());
+			CreateCellConnections(idx, connections);
+		}
+		offsets[nrOfCells] = int(connections.size());
+
+		// A row only touches the connection lists of its own cells
+		auto fillRow = [&](int r)
+		{
+			for (int c = 0; c < m_NrOfColumns; ++c)
+			{
+				const int idx = GetIndex(c, r);
+				m_Connections[idx].insert(m_Connections[idx].end(), connections.begin() + offsets[idx], connections.begin() + offsets[idx + 1]);
+			}
+		};
+
+		if (pThreadPool)
+			pThreadPool->ParallelFor(m_NrOfRows, fillRow);
+		else
+		{
+			for (int r = 0; r < m_NrOfRows; ++r)
+				fillRow(r);
+		}
+
+		// Skipped AddConnection, so the edge index is rebuilt once the bulk build ends
+		InvalidateConnectionIndex();
+		NotifyGraphModified(false, true);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	void GridGraph<T_NodeType, T_ConnectionType>::CreateCellConnections(int idx, vector<T_ConnectionType*>& connections)
+	{
+		const int col = idx % m_NrOfColumns;
+		const int row = idx / m_NrOfColumns;
+
+		// In an undirected graph every neighbour with a lower index was visited first and already added its connection
+		// back to this cell, with the cost it calculated itself. Those come first, in the order the neighbours were visited.
+		int earlierNeighbors[8];
+		int laterNeighbors[8];
+		int nrOfEarlierNeighbors = 0;
+		int nrOfLaterNeighbors = 0;
+
+		auto collectNeighbors = [&](const vector<Vector2>& directions)
+		{
+			for (auto d : directions)
+			{
+				int neighborCol = col + (int)d.x;
+				int neighborRow = row + (int)d.y;
+				if (!IsWithinBounds(neighborCol, neighborRow))
+					continue;
+
+				int neighborIdx = GetIndex(neighborCol, neighborRow);
+				if (!m_IsDirectionalGraph && neighborIdx < idx)
+					earlierNeighbors[nrOfEarlierNeighbors++] = neighborIdx;
+				else
+					laterNeighbors[nrOfLaterNeighbors++] = neighborIdx;
 			}
+		};
+
+		collectNeighbors(m_StraightDirections);
+		if (m_IsConnectedDiagonally)
+			collectNeighbors(m_DiagonalDirections);
+
+		std::sort(earlierNeighbors, earlierNeighbors + nrOfEarlierNeighbors);
+
+		for (int i = 0; i < nrOfEarlierNeighbors; ++i)
+		{
+			float connectionCost = CalculateConnectionCost(earlierNeighbors[i], idx);
+			if (connectionCost < 100000) //Extra check for different terrain types
+				connections.push_back(CreateConnection(idx, earlierNeighbors[i], connectionCost));
+		}
+
+		for (int i = 0; i < nrOfLaterNeighbors; ++i)
+		{
+			float connectionCost = CalculateConnectionCost(idx, laterNeighbors[i]);
+			if (connectionCost < 100000) //Extra check for different terrain types
+				connections.push_back(CreateConnection(idx, laterNeighbors[i], connectionCost));
 		}
 	}
 
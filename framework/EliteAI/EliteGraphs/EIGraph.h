@@ -9,10 +9,31 @@
 
 #include "EGraphNodeTypes.h"
 #include "EGraphConnectionTypes.h"
+#include "framework/EliteHelpers/EFlatHashMap.h"
+#include "framework/EliteHelpers/ESlabAllocator.h"
 #include <memory>
 
 namespace Elite
 {
+	// Read-only view on a contiguous range, like the connections of one node in a frozen graph
+	template <class T>
+	class Span
+	{
+	public:
+		Span() = default;
+		Span(const T* pBegin, const T* pEnd) : m_pBegin(pBegin), m_pEnd(pEnd) {}
+
+		const T* begin() const { return m_pBegin; }
+		const T* end() const { return m_pEnd; }
+		size_t size() const { return m_pEnd - m_pBegin; }
+		bool empty() const { return m_pBegin == m_pEnd; }
+		const T& operator[](size_t i) const { return m_pBegin[i]; }
+
+	private:
+		const T* m_pBegin = nullptr;
+		const T* m_pEnd = nullptr;
+	};
+
 	template <class T_NodeType, class T_ConnectionType>
 	class IGraph
 	{
@@ -21,6 +42,7 @@ namespace Elite
 		using NodeVector = std::vector<T_NodeType*>;
 		using ConnectionList = std::list<T_ConnectionType*>; // TODO: function definition doesn't recognize this?
 		using ConnectionListVector = std::vector<ConnectionList>;
+		using ConnectionSpan = Span<T_ConnectionType*>;
 
 	public:
 		IGraph(bool isDirectionalGraph);
@@ -36,14 +58,56 @@ namespace Elite
 
 		T_ConnectionType* GetConnection(int from, int to) const;
 		const ConnectionListVector& GetAllConnections() const { return m_Connections; }
+		// For graphs with implicit connections the list and its connections stay valid until the node or a neighbour changes
 		const ConnectionList& GetNodeConnections(int idx) const;
 		const ConnectionList& GetNodeConnections(T_NodeType* pNode) const { return GetNodeConnections(pNode->GetIndex()); }
 
+		// Compressed sparse row adjacency
+		// -------------------------------
+		// Freeze copies the connection pointers of every node into one contiguous array, with per node offsets into it.
+		// Read-mostly graphs can then walk the connections of a node as a span instead of a linked list.
+		// The lists stay the owners, any change to the nodes or connections unfreezes the graph again.
+		void Freeze();
+		void Unfreeze();
+		bool IsFrozen() const { return m_IsFrozen; }
+		bool HasImplicitConnections() const { return m_HasImplicitConnections; }
+		ConnectionSpan GetFrozenConnections(int idx) const;
+
+		// Calls function(pConnection) for every connection of the node, from the frozen arrays when available.
+		template <class T_Function>
+		void ForEachConnection(int idx, T_Function function) const;
+
+		// Node and connection storage
+		// ---------------------------
+		// Nodes and connections made with these come from slabs owned by the graph, so building a graph takes a
+		// handful of allocations instead of one per object. Objects made with new can still be added, the graph
+		// deletes every object the way it was created. Clear frees the slabs. A connection AddConnection didn't take
+		// goes back through DeleteConnection.
+		template <class... T_Args>
+		T_NodeType* CreateNode(T_Args&&... args) { return m_NodePool.Create(std::forward<T_Args>(args)...); }
+		template <class... T_Args>
+		T_ConnectionType* CreateConnection(T_Args&&... args) { return m_ConnectionPool.Create(std::forward<T_Args>(args)...); }
+		void ReserveNodes(int count) { m_NodePool.Reserve(count); }
+		void ReserveConnections(int count) { m_ConnectionPool.Reserve(count); }
+		void DeleteConnection(T_ConnectionType*& pConnection);
+
+		// Bulk construction
+		// -----------------
+		// Between BeginBulkBuild and EndBulkBuild OnGraphModified is held back, EndBulkBuild reports all changes
+		// in one call. The counts are the nodes and connections about to be added, storage for them is reserved.
+		// Builds can nest, only the outermost EndBulkBuild notifies.
+		void BeginBulkBuild(int nrOfNodes = 0, int nrOfConnections = 0);
+		void EndBulkBuild();
+		bool IsBulkBuilding() const { return m_BulkBuildDepth > 0; }
+
 		int GetNextFreeNodeIndex() const { return m_NextNodeIndex; }
 		int AddNode(T_NodeType* pNode);
 		void RemoveNode(int node);
 
-		void AddConnection(T_ConnectionType* pConnection);
+		// Returns whether the graph took ownership of pConnection. On false the caller still owns it: the connection
+		// already exists, one of its nodes is removed, or the graph has implicit connections. Those only unblock the
+		// connection and copy the cost of the passed one.
+		bool AddConnection(T_ConnectionType* pConnection);
 		void RemoveConnection(int from, int to);
 		void RemoveConnection(T_ConnectionType* pConnection);
 
@@ -91,17 +155,62 @@ namespace Elite
 
 		bool m_IsDirectionalGraph;
 
+		// Frozen adjacency, connections of node i are m_FrozenConnections[m_FrozenOffsets[i]] up to m_FrozenOffsets[i + 1]
+		std::vector<int> m_FrozenOffsets;
+		std::vector<T_ConnectionType*> m_FrozenConnections;
+		bool m_IsFrozen = false;
+
+		// Graphs that derive their connections from the layout of the nodes (like ImplicitGridGraph) set this before
+		// adding nodes. Nothing is stored in m_Connections then, connections come from GetImplicitConnections and
+		// adding or removing one only flips its blocked state.
+		bool m_HasImplicitConnections = false;
+		virtual const ConnectionList& GetImplicitConnections(int idx) const { return m_Connections[idx]; }
+		virtual void SetImplicitConnectionBlocked(int from, int to, bool isBlocked) {}
+		// Called when a node of an implicit graph is added or removed, its neighbours lose or gain a connection
+		virtual void RefreshImplicitConnections(int idx) {}
+
 		// protected functions
 		bool IsUniqueConnection(int from, int to) const;
+		void BlockImplicitConnections(int idx);
 
 		// Called whenever the graph is modified, to be overriden by derived classes
 		virtual void OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged) {}
+		// Calls OnGraphModified, or remembers the changes until the end of a bulk build
+		void NotifyGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged);
+
+		// Derived classes that fill m_Connections directly call this afterwards. The edge index is rebuilt right away,
+		// or once at the end of a bulk build. Until then lookups walk the connection lists.
+		void InvalidateConnectionIndex();
 
 	private:
 		int m_NextNodeIndex;
 
+		ESlabAllocator<T_NodeType> m_NodePool;
+		ESlabAllocator<T_ConnectionType> m_ConnectionPool;
+
+		int m_BulkBuildDepth = 0;
+		bool m_HasBulkNodeChanges = false;
+		bool m_HasBulkConnectionChanges = false;
+
+		// Edge index of the stored connections: every connection by its (from, to) pair, and per node the nodes
+		// with a connection to it. Lookups are O(1) and dropping the connections of a node is O(degree).
+		// Only the functions that change the graph update it, so const lookups are safe from several threads as long
+		// as no thread changes the graph meanwhile.
+		EFlatHashMap<T_ConnectionType*> m_ConnectionIndex;
+		std::vector<std::vector<int>> m_IncomingConnections;
+		bool m_IsConnectionIndexValid = true;
+
 		// private functions
 		void CullInvalidEdges();
+		static uint64_t GetConnectionKey(int from, int to) { return (uint64_t(uint32_t(from)) << 32) | uint32_t(to); }
+		void RebuildConnectionIndex();
+		T_ConnectionType* FindConnection(int from, int to) const;
+		void IndexConnection(T_ConnectionType* pConnection);
+		void UnindexConnection(int from, int to);
+		bool EraseConnection(int from, int to);
+		bool RemoveOutgoingConnections(int idx);
+		bool RemoveIncomingConnections(int idx);
+		void DeleteNode(T_NodeType*& pNode);
 	};
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -113,29 +222,41 @@ namespace Elite
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline IGraph<T_NodeType, T_ConnectionType>::IGraph(const IGraph& other)
+		: m_HasImplicitConnections(other.m_HasImplicitConnections)
 	{
 		for (auto& n : m_Nodes)
-			SAFE_DELETE(n);
+			DeleteNode(n);
 
 		for (auto& connectionList : m_Connections)
 		{
 			for (auto& connection : connectionList)
-				SAFE_DELETE(connection);
+				DeleteConnection(connection);
 		};
 
+		ReserveNodes(int(other.m_Nodes.size()));
 		for (auto n : other.m_Nodes)
-			m_Nodes.push_back(new T_NodeType(*n));
+			m_Nodes.push_back(CreateNode(*n));
 
-		for (auto cList : other.m_Connections)
+		//implicit graphs store no connections, the derived graph copies what it keeps itself
+		if (!m_HasImplicitConnections)
 		{
-			ConnectionList newList;
-			for (auto c : cList)
-				newList.push_back(new T_ConnectionType(*c));
-			m_Connections.push_back(newList);
+			ReserveConnections(other.GetNrOfConnections());
+			for (auto cList : other.m_Connections)
+			{
+				ConnectionList newList;
+				for (auto c : cList)
+					newList.push_back(CreateConnection(*c));
+				m_Connections.push_back(newList);
+			}
+
+			RebuildConnectionIndex();
 		}
 
 		m_IsDirectionalGraph = other.m_IsDirectionalGraph;
 		m_NextNodeIndex = other.m_NextNodeIndex;
+
+		if (other.m_IsFrozen)
+			Freeze();
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -171,13 +292,18 @@ namespace Elite
 			m_Nodes[to]->GetIndex() != invalid_node_index &&
 			"<Graph::GetConnection>: invalid 'to' index");
 
-		for (auto c : m_Connections[from])
+		if (m_HasImplicitConnections)
 		{
-			if (c && c->GetTo() == to)
-				return c;
+			for (auto c : GetImplicitConnections(from))
+			{
+				if (c && c->GetTo() == to)
+					return c;
+			}
+
+			return nullptr;
 		}
 
-		return nullptr;
+		return FindConnection(from, to);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -196,12 +322,75 @@ namespace Elite
 	{
 		assert((idx < (int)m_Nodes.size()) && (idx >= 0) && "<Graph::GetNode>: invalid index");
 
+		if (m_HasImplicitConnections)
+			return GetImplicitConnections(idx);
+
 		return m_Connections[idx];
 	}
 
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::Freeze()
+	{
+		//Implicit connections are computed on the fly, there are no lists to compress
+		if (m_HasImplicitConnections)
+			return;
+
+		m_FrozenOffsets.resize(m_Connections.size() + 1);
+		m_FrozenConnections.clear();
+		m_FrozenConnections.reserve(GetNrOfConnections());
+
+		for (size_t i = 0; i < m_Connections.size(); ++i)
+		{
+			m_FrozenOffsets[i] = int(m_FrozenConnections.size());
+			m_FrozenConnections.insert(m_FrozenConnections.end(), m_Connections[i].begin(), m_Connections[i].end());
+		}
+		m_FrozenOffsets.back() = int(m_FrozenConnections.size());
+
+		m_IsFrozen = true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::Unfreeze()
+	{
+		if (!m_IsFrozen)
+			return;
+
+		m_FrozenOffsets.clear();
+		m_FrozenConnections.clear();
+		m_IsFrozen = false;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline Span<T_ConnectionType*> IGraph<T_NodeType, T_ConnectionType>::GetFrozenConnections(int idx) const
+	{
+		assert(m_IsFrozen && "<Graph::GetFrozenConnections>: graph is not frozen");
+		assert((idx < (int)m_Nodes.size()) && (idx >= 0) && "<Graph::GetFrozenConnections>: invalid index");
+
+		T_ConnectionType* const* pConnections = m_FrozenConnections.data();
+		return Span<T_ConnectionType*>(pConnections + m_FrozenOffsets[idx], pConnections + m_FrozenOffsets[idx + 1]);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	template<class T_Function>
+	inline void IGraph<T_NodeType, T_ConnectionType>::ForEachConnection(int idx, T_Function function) const
+	{
+		if (m_IsFrozen)
+		{
+			for (auto c : GetFrozenConnections(idx))
+				function(c);
+		}
+		else
+		{
+			for (auto c : GetNodeConnections(idx))
+				function(c);
+		}
+	}
+
 	template<class T_NodeType, class T_ConnectionType>
 	inline int IGraph<T_NodeType, T_ConnectionType>::AddNode(T_NodeType* pNode)
 	{
+		Unfreeze();
+
 		if (pNode->GetIndex() < (int)m_Nodes.size())
 		{
 			//make sure the client is not trying to add a pNode with the same ID as
@@ -210,8 +399,10 @@ namespace Elite
 				"<Graph::AddNode>: Attempting to add a node with a duplicate ID");
 
 			m_Nodes[pNode->GetIndex()] = pNode;
+			if (m_HasImplicitConnections)
+				RefreshImplicitConnections(pNode->GetIndex());
 
-			OnGraphModified(true, false);
+			NotifyGraphModified(true, false);
 			return m_NextNodeIndex;
 		}
 		else
@@ -220,9 +411,13 @@ namespace Elite
 			assert(pNode->GetIndex() == m_NextNodeIndex && "<Graph::AddNode>:invalid index");
 
 			m_Nodes.push_back(pNode);
-			m_Connections.push_back(ConnectionList());
+			if (!m_HasImplicitConnections)
+			{
+				m_Connections.push_back(ConnectionList());
+				m_IncomingConnections.push_back(std::vector<int>());
+			}
 
-			OnGraphModified(true, false);
+			NotifyGraphModified(true, false);
 			return m_NextNodeIndex++;
 		}
 
@@ -231,6 +426,8 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveNode(int node)
 	{
+		Unfreeze();
+
 		//Removes pNode by setting it's index to invalid_node_index 
 		//This prevents the other indices from needing to be changed, however it can be reused when adding a new pNode with that index
 
@@ -239,61 +436,70 @@ namespace Elite
 		//set this pNode's index to invalid_node_index
 		m_Nodes[node]->SetIndex(invalid_node_index);
 
-		bool hadConnections = false;
+		//implicit connections skip invalid nodes, the lists around the node only have to be refilled
+		if (m_HasImplicitConnections)
+		{
+			RefreshImplicitConnections(node);
+			NotifyGraphModified(true, true);
+			return;
+		}
 
 		//if the graph is not directed remove all connections leading to this pNode and then
 		//clear the connections leading from the pNode
+		bool hadConnections = false;
 		if (!m_IsDirectionalGraph)
-		{
-			//visit each neighbour and erase any connections leading to this pNode
-			for (auto currentConnection = m_Connections[node].begin();
-				currentConnection != m_Connections[node].end();
-				++currentConnection)
-			{
-				for (auto& currentEdgeOnToNode = m_Connections[(*currentConnection)->GetTo()].begin();
-					currentEdgeOnToNode != m_Connections[(*currentConnection)->GetTo()].end();
-					++currentEdgeOnToNode)
-				{
-					if ((*currentEdgeOnToNode)->GetTo() == node)
-					{
-						hadConnections = true;
+			hadConnections = RemoveIncomingConnections(node);
 
-						auto conPtr = *currentEdgeOnToNode;
-						currentEdgeOnToNode = m_Connections[(*currentConnection)->GetTo()].erase(currentEdgeOnToNode);
-						SAFE_DELETE(conPtr);
-
-						break;
-					}
-				}
-			}
-		}
-
-		//finally, clear this pNode's connections
-		for (auto& connection : m_Connections[node])
-		{
+		if (RemoveOutgoingConnections(node))
 			hadConnections = true;
-			SAFE_DELETE(connection);
-		}
-		m_Connections[node].clear();
 
-		OnGraphModified(true, hadConnections);
+		NotifyGraphModified(true, hadConnections);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
-	inline void IGraph<T_NodeType, T_ConnectionType>::AddConnection(T_ConnectionType* pConnection)
+	inline bool IGraph<T_NodeType, T_ConnectionType>::AddConnection(T_ConnectionType* pConnection)
 	{
+		Unfreeze();
+
 		//first make sure the from and to nodes exist within the graph 
 		assert((pConnection->GetFrom() < m_NextNodeIndex) && (pConnection->GetTo() < m_NextNodeIndex) && (pConnection->GetTo() != pConnection->GetFrom()) &&
 			"<Graph::AddConnection>: invalid node index");
 
+		//implicit connections always exist, adding one unblocks it and gives it the cost of the passed one.
+		//The passed connection isn't kept, it stays with the caller.
+		if (m_HasImplicitConnections)
+		{
+			const int from = pConnection->GetFrom();
+			const int to = pConnection->GetTo();
+			SetImplicitConnectionBlocked(from, to, false);
+			if (!m_IsDirectionalGraph)
+				SetImplicitConnectionBlocked(to, from, false);
+
+			if (m_Nodes[from]->GetIndex() != invalid_node_index && m_Nodes[to]->GetIndex() != invalid_node_index)
+			{
+				if (T_ConnectionType* pStoredConnection = GetConnection(from, to))
+					pStoredConnection->SetCost(pConnection->GetCost());
+				if (!m_IsDirectionalGraph)
+				{
+					if (T_ConnectionType* pStoredConnection = GetConnection(to, from))
+						pStoredConnection->SetCost(pConnection->GetCost());
+				}
+			}
+
+			NotifyGraphModified(false, true);
+			return false;
+		}
+
 		//make sure both nodes are active before adding the pConnection
 		if ((m_Nodes[pConnection->GetTo()]->GetIndex() != invalid_node_index) &&
 			(m_Nodes[pConnection->GetFrom()]->GetIndex() != invalid_node_index))
 		{
-			//add the pConnection, first making sure it is unique
-			assert(IsUniqueConnection(pConnection->GetFrom(), pConnection->GetTo()) && "Connection already exists on this graph");
-			
+			//add the pConnection, first making sure it is unique. A duplicate stays with the caller
+			if (!IsUniqueConnection(pConnection->GetFrom(), pConnection->GetTo()))
+				return false;
+
 			m_Connections[pConnection->GetFrom()].push_back(pConnection);
+			IndexConnection(pConnection);
 
 			//if the graph is undirected we must add another pConnection in the opposite
 			//direction
@@ -302,58 +508,48 @@ namespace Elite
 				//check to make sure the pConnection is unique before adding
 				if (IsUniqueConnection(pConnection->GetTo(), pConnection->GetFrom()))
 				{
-					T_ConnectionType* oppositeDirEdge = new T_ConnectionType();
+					T_ConnectionType* oppositeDirEdge = CreateConnection();
 
 					oppositeDirEdge->SetCost(pConnection->GetCost());
 					oppositeDirEdge->SetTo(pConnection->GetFrom());
 					oppositeDirEdge->SetFrom(pConnection->GetTo());
 
 					m_Connections[pConnection->GetTo()].push_back(oppositeDirEdge);
+					IndexConnection(oppositeDirEdge);
 				}
 			}
 		}
+		else
+			return false;
 		
-		OnGraphModified(false, true);
+		NotifyGraphModified(false, true);
+		return true;
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveConnection(int from, int to)
 	{
+		Unfreeze();
+
 		assert((from < (int)m_Nodes.size()) && (to < (int)m_Nodes.size()) &&
 			"<Graph::RemoveConnection>:invalid node index");
 
-		auto conFromTo = GetConnection(from, to);
-		auto conToFrom = GetConnection(to, from);
-
-		if (!m_IsDirectionalGraph)
+		if (m_HasImplicitConnections)
 		{
-			for (auto& curEdge = m_Connections[to].begin();
-				curEdge != m_Connections[to].end();
-				++curEdge)
-			{
-				if ((*curEdge)->GetTo() == from) 
-				{ 
-					curEdge = m_Connections[to].erase(curEdge); 
-					break; 
-				}
-			}
-		}
+			SetImplicitConnectionBlocked(from, to, true);
+			if (!m_IsDirectionalGraph)
+				SetImplicitConnectionBlocked(to, from, true);
 
-		for (auto& curEdge = m_Connections[from].begin();
-			curEdge != m_Connections[from].end();
-			++curEdge)
-		{
-			if ((*curEdge)->GetTo() == to) 
-			{ 
-				curEdge = m_Connections[from].erase(curEdge); 
-				break; 
-			}
+			NotifyGraphModified(false, true);
+			return;
 		}
 
-		SAFE_DELETE(conFromTo);
-		SAFE_DELETE(conToFrom);
+		//in a directed graph the connection back is a separate one, it stays
+		EraseConnection(from, to);
+		if (!m_IsDirectionalGraph)
+			EraseConnection(to, from);
 
-		OnGraphModified(false, true);
+		NotifyGraphModified(false, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -365,24 +561,20 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveConnectionsToAdjacentNodes(int idx)
 	{
-		// remove and delete connections from this pNode
-		for (auto c : m_Connections[idx])
-			delete c;
-		m_Connections[idx].clear();
+		Unfreeze();
 
-		// remove and delete connections from other nodes to this pNode
-		auto isConnectionToThisNode = [idx](T_ConnectionType* pCon) { return pCon->GetTo() == idx; };
-		for (auto& c : m_Connections)
+		if (m_HasImplicitConnections)
 		{
-			list<T_ConnectionType*>::iterator foundIt;
-			while ((foundIt = std::find_if(c.begin(), c.end(), isConnectionToThisNode))	!= c.end())
-			{
-				delete *foundIt;
-				c.erase(foundIt);
-			}
+			BlockImplicitConnections(idx);
+			NotifyGraphModified(false, true);
+			return;
 		}
 
-		OnGraphModified(false, true);
+		// remove and delete connections from this pNode, then the ones from other nodes to this pNode
+		RemoveOutgoingConnections(idx);
+		RemoveIncomingConnections(idx);
+
+		NotifyGraphModified(false, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -392,17 +584,9 @@ namespace Elite
 		assert((from < (int)m_Nodes.size()) && (to < (int)m_Nodes.size()) &&
 			"<Graph::SetEdgeCost>: invalid index");
 
-		//visit each neighbour and erase any connections leading to this pNode
-		for (auto& curEdge = m_Connections[from].begin();
-			curEdge != m_Connections[from].end();
-			++curEdge)
-		{
-			if (curEdge->GetTo() == to)
-			{
-				curEdge->SetCost(cost);
-				break;
-			}
-		}
+		auto pConnection = GetConnection(from, to);
+		if (pConnection)
+			pConnection->SetCost(cost);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -420,31 +604,50 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline int IGraph<T_NodeType, T_ConnectionType>::GetNrOfConnections() const
 	{
+		if (m_IsFrozen)
+			return int(m_FrozenConnections.size());
+
 		int tot = 0;
 
-		for (auto curEdge = m_Connections.begin();
-			curEdge != m_Connections.end();
-			++curEdge)
+		if (m_HasImplicitConnections)
 		{
-			tot += curEdge->size();
+			for (int idx = 0; idx < (int)m_Nodes.size(); ++idx)
+				tot += int(GetImplicitConnections(idx).size());
+
+			return tot;
 		}
 
+		if (m_IsConnectionIndexValid)
+			return int(m_ConnectionIndex.Size());
+
+		for (auto& connectionList : m_Connections)
+			tot += int(connectionList.size());
+
 		return tot;
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::Clear()
 	{
+		Unfreeze();
+
 		for (auto& n : m_Nodes)
-			SAFE_DELETE(n);
+			DeleteNode(n);
 		m_Nodes.clear();
 
 		for (auto& connectionList : m_Connections)
 		{
 			for (auto& connection : connectionList)
-				SAFE_DELETE(connection);
+				DeleteConnection(connection);
 		}
 		m_Connections.clear();
+		m_ConnectionIndex = EFlatHashMap<T_ConnectionType*>();
+		m_IncomingConnections.clear();
+		m_IsConnectionIndexValid = true;
+
+		//every pooled object is destroyed by now, hand the slabs back in one go
+		m_NodePool.Release();
+		m_ConnectionPool.Release();
 
 		m_NextNodeIndex = 0;
 	}
@@ -452,8 +655,29 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline void IGraph<T_NodeType, T_ConnectionType>::RemoveConnections()
 	{
+		Unfreeze();
+
+		if (m_HasImplicitConnections)
+		{
+			for (int idx = 0; idx < (int)m_Nodes.size(); ++idx)
+				BlockImplicitConnections(idx);
+
+			NotifyGraphModified(false, true);
+			return;
+		}
+
 		for (auto& connectionList : m_Connections)
+		{
+			for (auto& connection : connectionList)
+				DeleteConnection(connection);
 			connectionList.clear();
+		}
+
+		m_ConnectionIndex.Clear();
+		m_IncomingConnections.assign(m_Connections.size(), std::vector<int>());
+		m_IsConnectionIndexValid = true;
+
+		NotifyGraphModified(false, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -507,15 +731,23 @@ namespace Elite
 	template<class T_NodeType, class T_ConnectionType>
 	inline bool IGraph<T_NodeType, T_ConnectionType>::IsUniqueConnection(int from, int to) const
 	{
-		for(auto c : m_Connections[from])
+		return FindConnection(from, to) == nullptr;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::BlockImplicitConnections(int idx)
+	{
+		//blocking takes connections out of the returned list, so copy the neighbours first
+		std::vector<int> neighbours{};
+		for (auto c : GetImplicitConnections(idx))
+			neighbours.push_back(c->GetTo());
+
+		for (int to : neighbours)
 		{
-			if (c->GetTo() == to)
-			{
-				return false;
-			}
+			SetImplicitConnectionBlocked(idx, to, true);
+			if (!m_IsDirectionalGraph)
+				SetImplicitConnectionBlocked(to, idx, true);
 		}
-
-		return true;
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
@@ -533,4 +765,199 @@ namespace Elite
 			}
 		}
 	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::BeginBulkBuild(int nrOfNodes /* = 0 */, int nrOfConnections /* = 0 */)
+	{
+		if (nrOfNodes > 0)
+		{
+			m_Nodes.reserve(m_Nodes.size() + nrOfNodes);
+			if (!m_HasImplicitConnections)
+			{
+				m_Connections.reserve(m_Connections.size() + nrOfNodes);
+				m_IncomingConnections.reserve(m_IncomingConnections.size() + nrOfNodes);
+			}
+			ReserveNodes(nrOfNodes);
+		}
+
+		if (nrOfConnections > 0 && !m_HasImplicitConnections)
+			ReserveConnections(nrOfConnections);
+
+		++m_BulkBuildDepth;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::EndBulkBuild()
+	{
+		assert(m_BulkBuildDepth > 0 && "<Graph::EndBulkBuild>: no bulk build in progress");
+		if (m_BulkBuildDepth == 0 || --m_BulkBuildDepth > 0)
+			return;
+
+		if (!m_IsConnectionIndexValid)
+			RebuildConnectionIndex();
+
+		if (m_HasBulkNodeChanges || m_HasBulkConnectionChanges)
+			OnGraphModified(m_HasBulkNodeChanges, m_HasBulkConnectionChanges);
+
+		m_HasBulkNodeChanges = false;
+		m_HasBulkConnectionChanges = false;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::NotifyGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged)
+	{
+		if (m_BulkBuildDepth == 0)
+		{
+			OnGraphModified(nrOfNodesChanged, nrOfConnectionsChanged);
+			return;
+		}
+
+		m_HasBulkNodeChanges = m_HasBulkNodeChanges || nrOfNodesChanged;
+		m_HasBulkConnectionChanges = m_HasBulkConnectionChanges || nrOfConnectionsChanged;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::InvalidateConnectionIndex()
+	{
+		m_IsConnectionIndexValid = false;
+		if (m_BulkBuildDepth == 0)
+			RebuildConnectionIndex();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::RebuildConnectionIndex()
+	{
+		size_t nrOfConnections = 0;
+		for (auto& connectionList : m_Connections)
+			nrOfConnections += connectionList.size();
+
+		m_ConnectionIndex.Clear();
+		m_ConnectionIndex.Reserve(nrOfConnections);
+		m_IncomingConnections.assign(m_Connections.size(), std::vector<int>());
+
+		for (auto& connectionList : m_Connections)
+		{
+			for (auto c : connectionList)
+			{
+				m_ConnectionIndex.Insert(GetConnectionKey(c->GetFrom(), c->GetTo()), c);
+				m_IncomingConnections[c->GetTo()].push_back(c->GetFrom());
+			}
+		}
+
+		m_IsConnectionIndexValid = true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline T_ConnectionType* IGraph<T_NodeType, T_ConnectionType>::FindConnection(int from, int to) const
+	{
+		if (m_IsConnectionIndexValid)
+		{
+			T_ConnectionType* const* ppConnection = m_ConnectionIndex.Find(GetConnectionKey(from, to));
+			return ppConnection ? *ppConnection : nullptr;
+		}
+
+		//only during a bulk build that filled the lists directly
+		for (auto c : m_Connections[from])
+		{
+			if (c->GetTo() == to)
+				return c;
+		}
+		return nullptr;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::IndexConnection(T_ConnectionType* pConnection)
+	{
+		if (!m_IsConnectionIndexValid)
+			return;
+
+		m_ConnectionIndex.Insert(GetConnectionKey(pConnection->GetFrom(), pConnection->GetTo()), pConnection);
+		m_IncomingConnections[pConnection->GetTo()].push_back(pConnection->GetFrom());
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::UnindexConnection(int from, int to)
+	{
+		if (!m_IsConnectionIndexValid)
+			return;
+
+		m_ConnectionIndex.Erase(GetConnectionKey(from, to));
+
+		//the order of incoming connections doesn't matter, swap the removed one with the last
+		auto& incomingConnections = m_IncomingConnections[to];
+		auto foundIt = std::find(incomingConnections.begin(), incomingConnections.end(), from);
+		if (foundIt != incomingConnections.end())
+		{
+			*foundIt = incomingConnections.back();
+			incomingConnections.pop_back();
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool IGraph<T_NodeType, T_ConnectionType>::EraseConnection(int from, int to)
+	{
+		T_ConnectionType* pConnection = FindConnection(from, to);
+		if (!pConnection)
+			return false;
+
+		m_Connections[from].remove(pConnection);
+		UnindexConnection(from, to);
+		DeleteConnection(pConnection);
+
+		return true;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool IGraph<T_NodeType, T_ConnectionType>::RemoveOutgoingConnections(int idx)
+	{
+		const bool hadConnections = !m_Connections[idx].empty();
+
+		for (auto& connection : m_Connections[idx])
+		{
+			UnindexConnection(idx, connection->GetTo());
+			DeleteConnection(connection);
+		}
+		m_Connections[idx].clear();
+
+		return hadConnections;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool IGraph<T_NodeType, T_ConnectionType>::RemoveIncomingConnections(int idx)
+	{
+		//the incoming connections are only known through the edge index
+		if (!m_IsConnectionIndexValid)
+			RebuildConnectionIndex();
+
+		//erasing changes the incoming connections of idx, so walk a copy
+		const std::vector<int> fromNodes = m_IncomingConnections[idx];
+		for (int from : fromNodes)
+			EraseConnection(from, idx);
+
+		return !fromNodes.empty();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::DeleteNode(T_NodeType*& pNode)
+	{
+		if (m_NodePool.Owns(pNode))
+		{
+			m_NodePool.Destroy(pNode);
+			pNode = nullptr;
+		}
+		else
+			SAFE_DELETE(pNode);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void IGraph<T_NodeType, T_ConnectionType>::DeleteConnection(T_ConnectionType*& pConnection)
+	{
+		if (m_ConnectionPool.Owns(pConnection))
+		{
+			m_ConnectionPool.Destroy(pConnection);
+			pConnection = nullptr;
+		}
+		else
+			SAFE_DELETE(pConnection);
+	}
 }
\ No newline at end of file
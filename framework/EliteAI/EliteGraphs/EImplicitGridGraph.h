@@ -0,0 +1,368 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EImplicitGridGraph.h: Grid shaped graph that builds no connections up front. The neighbours of a cell follow
+// from its column and row, blocked connections are one bit per direction per cell. The connection objects of a
+// cell are made the first time the cell is queried and live as long as the graph, so cells nobody visits only
+// cost a pointer.
+/*=============================================================================*/
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "EIGraph.h"
+#include "EGraphConnectionTypes.h"
+#include "EGraphNodeTypes.h"
+
+namespace Elite
+{
+	template<class T_NodeType, class T_ConnectionType>
+	class ImplicitGridGraph : public IGraph<T_NodeType, T_ConnectionType>
+	{
+	public:
+		using ConnectionList = typename IGraph<T_NodeType, T_ConnectionType>::ConnectionList;
+
+		ImplicitGridGraph(int columns, int rows, int cellSize, bool isDirectionalGraph, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5);
+		ImplicitGridGraph(const ImplicitGridGraph& other);
+		virtual ~ImplicitGridGraph();
+
+		using IGraph<T_NodeType, T_ConnectionType>::GetNode;
+		T_NodeType* GetNode(int col, int row) const { return this->m_Nodes[GetIndex(col, row)]; }
+
+		int GetRows() const { return m_NrOfRows; }
+		int GetColumns() const { return m_NrOfColumns; }
+
+		bool IsWithinBounds(int col, int row) const { return (col >= 0 && col < m_NrOfColumns && row >= 0 && row < m_NrOfRows); }
+		int GetIndex(int col, int row) const { return row * m_NrOfColumns + col; }
+
+		// Blocked connections stay blocked until they are added again, RemoveConnection and AddConnection go through here
+		bool IsConnectionBlocked(int from, int to) const;
+
+		// returns the column and row of the node in a Vector2
+		using IGraph<T_NodeType, T_ConnectionType>::GetNodePos;
+		virtual Vector2 GetNodePos(T_NodeType* pNode) const override;
+
+		// returns the actual world position of the node
+		using IGraph<T_NodeType, T_ConnectionType>::GetNodeWorldPos;
+		Vector2 GetNodeWorldPos(int col, int row) const;
+		Vector2 GetNodeWorldPos(int idx) const override;
+
+		int GetNodeIdxAtWorldPos(const Elite::Vector2& pos) const override;
+
+	protected:
+		virtual const ConnectionList& GetImplicitConnections(int idx) const override;
+		virtual void SetImplicitConnectionBlocked(int from, int to, bool isBlocked) override;
+		virtual void RefreshImplicitConnections(int idx) override;
+
+	private:
+		static const int NR_OF_DIRECTIONS = 8;
+
+		int m_NrOfColumns;
+		int m_NrOfRows;
+		int m_CellSize;
+
+		bool m_IsConnectedDiagonally;
+		float m_DefaultCostStraight;
+		float m_DefaultCostDiagonal;
+
+		// Same order as the connections of a cell in an undirected GridGraph, so ties in searches resolve the same way
+		const int m_DirectionCols[NR_OF_DIRECTIONS] = { -1, 0, 1, -1, 1, 0, 1, -1 };
+		const int m_DirectionRows[NR_OF_DIRECTIONS] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+
+		// Bit d of a cell is set when the connection in direction d is blocked
+		std::vector<uint8_t> m_BlockedDirections;
+
+		// One connection per direction, the list holds the ones that are currently usable. Blocking a direction
+		// only takes its connection out of the list, the object and its cost stay.
+		struct CellConnections
+		{
+			T_ConnectionType connections[NR_OF_DIRECTIONS];
+			ConnectionList list;
+		};
+
+		// Filled in by the first query of a cell. Queries may come from several threads, the mutex only guards
+		// making a cell, reading one that exists is lock free.
+		std::unique_ptr<std::atomic<CellConnections*>[]> m_pCells;
+		mutable ESlabAllocator<CellConnections> m_CellPool;
+		mutable std::mutex m_CellMutex;
+
+		void InitializeGrid();
+		void InitializeCells();
+		CellConnections& GetCellConnections(int idx) const;
+		void FillConnectionList(int idx, CellConnections& cell) const;
+		int GetDirection(int from, int to) const;
+		bool IsDiagonal(int direction) const { return m_DirectionCols[direction] != 0 && m_DirectionRows[direction] != 0; }
+		float CalculateConnectionCost(int fromIdx, int toIdx, int direction) const;
+	};
+
+	template<class T_NodeType, class T_ConnectionType>
+	ImplicitGridGraph<T_NodeType, T_ConnectionType>::ImplicitGridGraph(
+		int columns,
+		int rows,
+		int cellSize,
+		bool isDirectionalGraph,
+		bool isConnectedDiagonally,
+		float costStraight /* = 1.f*/,
+		float costDiagonal /* = 1.5f */)
+		: IGraph<T_NodeType, T_ConnectionType>(isDirectionalGraph)
+		, m_NrOfColumns(columns)
+		, m_NrOfRows(rows)
+		, m_CellSize(cellSize)
+		, m_IsConnectedDiagonally(isConnectedDiagonally)
+		, m_DefaultCostStraight(costStraight)
+		, m_DefaultCostDiagonal(costDiagonal)
+	{
+		InitializeGrid();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	ImplicitGridGraph<T_NodeType, T_ConnectionType>::ImplicitGridGraph(const ImplicitGridGraph& other)
+		: IGraph<T_NodeType, T_ConnectionType>(other)
+		, m_NrOfColumns(other.m_NrOfColumns)
+		, m_NrOfRows(other.m_NrOfRows)
+		, m_CellSize(other.m_CellSize)
+		, m_IsConnectedDiagonally(other.m_IsConnectedDiagonally)
+		, m_DefaultCostStraight(other.m_DefaultCostStraight)
+		, m_DefaultCostDiagonal(other.m_DefaultCostDiagonal)
+		, m_BlockedDirections(other.m_BlockedDirections)
+	{
+		InitializeCells();
+
+		// Copy the cells the other graph made, costs set on their connections have to come along
+		for (int idx = 0; idx < m_NrOfColumns * m_NrOfRows; ++idx)
+		{
+			const CellConnections* pOtherCell = other.m_pCells[idx].load(std::memory_order_acquire);
+			if (!pOtherCell)
+				continue;
+
+			CellConnections* pCell = m_CellPool.Create();
+			for (int direction = 0; direction < NR_OF_DIRECTIONS; ++direction)
+				pCell->connections[direction] = pOtherCell->connections[direction];
+			FillConnectionList(idx, *pCell);
+			m_pCells[idx].store(pCell, std::memory_order_relaxed);
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	ImplicitGridGraph<T_NodeType, T_ConnectionType>::~ImplicitGridGraph()
+	{
+		for (int idx = 0; idx < m_NrOfColumns * m_NrOfRows; ++idx)
+			m_CellPool.Destroy(m_pCells[idx].load(std::memory_order_relaxed));
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void ImplicitGridGraph<T_NodeType, T_ConnectionType>::InitializeGrid()
+	{
+		this->m_HasImplicitConnections = true;
+
+		// Create all nodes, the connections need nothing but the grid size
+		this->BeginBulkBuild(m_NrOfColumns * m_NrOfRows);
+		for (auto r = 0; r < m_NrOfRows; ++r)
+		{
+			for (auto c = 0; c < m_NrOfColumns; ++c)
+			{
+				this->AddNode(this->CreateNode(GetIndex(c, r)));
+			}
+		}
+
+		m_BlockedDirections.assign(size_t(m_NrOfColumns) * m_NrOfRows, 0);
+		InitializeCells();
+
+		this->NotifyGraphModified(false, true);
+		this->EndBulkBuild();
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void ImplicitGridGraph<T_NodeType, T_ConnectionType>::InitializeCells()
+	{
+		// Value initialized, every cell starts without connections
+		m_pCells.reset(new std::atomic<CellConnections*>[size_t(m_NrOfColumns) * m_NrOfRows]());
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline bool ImplicitGridGraph<T_NodeType, T_ConnectionType>::IsConnectionBlocked(int from, int to) const
+	{
+		const int direction = GetDirection(from, to);
+		return direction == -1 || (m_BlockedDirections[from] & (1 << direction)) != 0;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	const typename ImplicitGridGraph<T_NodeType, T_ConnectionType>::ConnectionList& ImplicitGridGraph<T_NodeType, T_ConnectionType>::GetImplicitConnections(int idx) const
+	{
+		return GetCellConnections(idx).list;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	typename ImplicitGridGraph<T_NodeType, T_ConnectionType>::CellConnections& ImplicitGridGraph<T_NodeType, T_ConnectionType>::GetCellConnections(int idx) const
+	{
+		CellConnections* pCell = m_pCells[idx].load(std::memory_order_acquire);
+		if (pCell)
+			return *pCell;
+
+		std::lock_guard<std::mutex> lock(m_CellMutex);
+
+		// Another thread may have made the cell while this one waited
+		pCell = m_pCells[idx].load(std::memory_order_relaxed);
+		if (pCell)
+			return *pCell;
+
+		pCell = m_CellPool.Create();
+
+		const int col = idx % m_NrOfColumns;
+		const int row = idx / m_NrOfColumns;
+		for (int direction = 0; direction < NR_OF_DIRECTIONS; ++direction)
+		{
+			const int neighborCol = col + m_DirectionCols[direction];
+			const int neighborRow = row + m_DirectionRows[direction];
+			if (!IsWithinBounds(neighborCol, neighborRow))
+				continue;
+
+			const int neighborIdx = GetIndex(neighborCol, neighborRow);
+			T_ConnectionType& connection = pCell->connections[direction];
+			connection.SetFrom(idx);
+			connection.SetTo(neighborIdx);
+			connection.SetCost(CalculateConnectionCost(idx, neighborIdx, direction));
+		}
+
+		FillConnectionList(idx, *pCell);
+		m_pCells[idx].store(pCell, std::memory_order_release);
+		return *pCell;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void ImplicitGridGraph<T_NodeType, T_ConnectionType>::FillConnectionList(int idx, CellConnections& cell) const
+	{
+		cell.list.clear();
+
+		if (this->m_Nodes[idx]->GetIndex() == invalid_node_index)
+			return;
+
+		const int col = idx % m_NrOfColumns;
+		const int row = idx / m_NrOfColumns;
+		const uint8_t blockedDirections = m_BlockedDirections[idx];
+
+		for (int direction = 0; direction < NR_OF_DIRECTIONS; ++direction)
+		{
+			if ((blockedDirections & (1 << direction)) || (!m_IsConnectedDiagonally && IsDiagonal(direction)))
+				continue;
+
+			if (!IsWithinBounds(col + m_DirectionCols[direction], row + m_DirectionRows[direction]))
+				continue;
+
+			T_ConnectionType& connection = cell.connections[direction];
+			if (this->m_Nodes[connection.GetTo()]->GetIndex() == invalid_node_index)
+				continue;
+
+			if (connection.GetCost() >= 100000) //Extra check for different terrain types, like GridGraph
+				continue;
+
+			cell.list.push_back(&connection);
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void ImplicitGridGraph<T_NodeType, T_ConnectionType>::RefreshImplicitConnections(int idx)
+	{
+		// A node that comes or goes changes its own connections and the ones of its neighbours towards it
+		const int col = idx % m_NrOfColumns;
+		const int row = idx / m_NrOfColumns;
+		for (int r = row - 1; r <= row + 1; ++r)
+		{
+			for (int c = col - 1; c <= col + 1; ++c)
+			{
+				if (!IsWithinBounds(c, r))
+					continue;
+
+				CellConnections* pCell = m_pCells[GetIndex(c, r)].load(std::memory_order_relaxed);
+				if (pCell)
+					FillConnectionList(GetIndex(c, r), *pCell);
+			}
+		}
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline void ImplicitGridGraph<T_NodeType, T_ConnectionType>::SetImplicitConnectionBlocked(int from, int to, bool isBlocked)
+	{
+		const int direction = GetDirection(from, to);
+		assert(direction != -1 && "<ImplicitGridGraph::SetImplicitConnectionBlocked>: cells are not adjacent");
+		if (direction == -1)
+			return;
+
+		if (isBlocked)
+			m_BlockedDirections[from] |= uint8_t(1 << direction);
+		else
+			m_BlockedDirections[from] &= uint8_t(~(1 << direction));
+
+		CellConnections* pCell = m_pCells[from].load(std::memory_order_relaxed);
+		if (pCell)
+			FillConnectionList(from, *pCell);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int ImplicitGridGraph<T_NodeType, T_ConnectionType>::GetDirection(int from, int to) const
+	{
+		const int colOffset = to % m_NrOfColumns - from % m_NrOfColumns;
+		const int rowOffset = to / m_NrOfColumns - from / m_NrOfColumns;
+
+		for (int direction = 0; direction < NR_OF_DIRECTIONS; ++direction)
+		{
+			if (m_DirectionCols[direction] == colOffset && m_DirectionRows[direction] == rowOffset)
+				return direction;
+		}
+
+		return -1;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline float ImplicitGridGraph<T_NodeType, T_ConnectionType>::CalculateConnectionCost(int fromIdx, int toIdx, int direction) const
+	{
+		return IsDiagonal(direction) ? m_DefaultCostDiagonal : m_DefaultCostStraight;
+	}
+
+	template<>
+	inline float ImplicitGridGraph<GridTerrainNode, GraphConnection>::CalculateConnectionCost(int fromIdx, int toIdx, int direction) const
+	{
+		float cost = IsDiagonal(direction) ? m_DefaultCostDiagonal : m_DefaultCostStraight;
+		cost *= (int(GetNode(fromIdx)->GetTerrainType()) + int(GetNode(toIdx)->GetTerrainType())) / 2.0f;
+
+		return cost;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	Elite::Vector2 ImplicitGridGraph<T_NodeType, T_ConnectionType>::GetNodePos(T_NodeType* pNode) const
+	{
+		auto col = pNode->GetIndex() % m_NrOfColumns;
+		auto row = pNode->GetIndex() / m_NrOfColumns;
+
+		return Vector2{ float(col), float(row) };
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	Elite::Vector2 ImplicitGridGraph<T_NodeType, T_ConnectionType>::GetNodeWorldPos(int col, int row) const
+	{
+		Vector2 cellCenterOffset = { m_CellSize / 2.f, m_CellSize / 2.f };
+		return Vector2{ (float)col * m_CellSize, (float)row * m_CellSize } + cellCenterOffset;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	Elite::Vector2 ImplicitGridGraph<T_NodeType, T_ConnectionType>::GetNodeWorldPos(int idx) const
+	{
+		return GetNodeWorldPos(idx % m_NrOfColumns, idx / m_NrOfColumns);
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	inline int ImplicitGridGraph<T_NodeType, T_ConnectionType>::GetNodeIdxAtWorldPos(const Elite::Vector2& pos) const
+	{
+		if (pos.x < 0 || pos.y < 0)
+			return invalid_node_index;
+
+		int c = int(pos.x / m_CellSize);
+		int r = int(pos.y / m_CellSize);
+
+		if (!IsWithinBounds(c, r))
+			return invalid_node_index;
+
+		return GetIndex(c, r);
+	}
+}
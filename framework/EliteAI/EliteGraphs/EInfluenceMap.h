@@ -58,10 +58,8 @@ namespace Elite
 
 			for (auto node : nodes)
 			{
-				auto nodeConnections = GetNodeConnections(node);
-
 				float biggestInfluence{};
-				for (auto connection : nodeConnections)
+				ForEachConnection(node->GetIndex(), [&](auto connection)
 				{
 					float newInfluence = GetNode(connection->GetTo())->GetInfluence() * expf(-connection->GetCost() * m_Decay);
 
@@ -69,7 +67,7 @@ namespace Elite
 					{
 						biggestInfluence = newInfluence;
 					}
-				}
+				});
 
 				float selfInfluence = node->GetInfluence() * expf(-m_Decay);
 				if (abs(selfInfluence) > abs(biggestInfluence))
@@ -65,11 +65,18 @@ void Elite::NavGraph::CreateNavigationGraph()
 		if (tempTriangles.size() > 1)
 		{
 			Elite::Vector2 midPoint{(line->p1.x + line->p2.x) / 2.f, (line->p1.y + line->p2.y) / 2.f };
-			AddNode(new NavGraphNode{ int(m_Nodes.size()), line->index, midPoint});
+			AddNode(CreateNode(int(m_Nodes.size()), line->index, midPoint));
 		}
 	}
 	
-	//2. Create connections now that every node is created
+	//2. Create connections now that every node is created, a connection the graph rejects goes back to the pool
+	auto addConnection = [this](int from, int to)
+	{
+		GraphConnection2D* pConnection = CreateConnection(from, to);
+		if (!AddConnection(pConnection))
+			DeleteConnection(pConnection);
+	};
+
 	for (const Triangle* triangle : triangles)
 	{
 		std::vector<NavGraphNode*> validNodes{};
@@ -88,15 +95,15 @@ void Elite::NavGraph::CreateNavigationGraph()
 		if (validNodes.size() == 2)
 		{
 			if (IsUniqueConnection(validNodes[0]->GetIndex(), validNodes[1]->GetIndex()))
-				AddConnection(new GraphConnection2D{ validNodes[0]->GetIndex(), validNodes[1]->GetIndex()});
+				addConnection(validNodes[0]->GetIndex(), validNodes[1]->GetIndex());
 		}
 		else if (validNodes.size() == 3)
 		{
 			if (IsUniqueConnection(validNodes[0]->GetIndex(), validNodes[1]->GetIndex()))
 			{
-			AddConnection(new GraphConnection2D{ validNodes[0]->GetIndex(), validNodes[1]->GetIndex() });
-			AddConnection(new GraphConnection2D{ validNodes[1]->GetIndex(), validNodes[2]->GetIndex() });
-			AddConnection(new GraphConnection2D{ validNodes[2]->GetIndex(), validNodes[0]->GetIndex() });
+			addConnection(validNodes[0]->GetIndex(), validNodes[1]->GetIndex());
+			addConnection(validNodes[1]->GetIndex(), validNodes[2]->GetIndex());
+			addConnection(validNodes[2]->GetIndex(), validNodes[0]->GetIndex());
 			}
 		}	
 	}
@@ -74,9 +74,8 @@ namespace Elite
 			}
 			else
 			{
-				list<T_ConnectionType*> neighbours = m_pGraph->GetNodeConnections(currentRecord.pNode->GetIndex());
 				float gCost{};
-				for (T_ConnectionType* connection : neighbours)
+				m_pGraph->ForEachConnection(currentRecord.pNode->GetIndex(), [&](T_ConnectionType* connection)
 				{
 					gCost = currentRecord.costSoFar + connection->GetCost();
 					T_NodeType* neighbourNode{ m_pGraph->GetNode(connection->GetTo()) };
@@ -112,7 +111,7 @@ namespace Elite
 					}
 					if (check)
 						openList.push_back(NodeRecord{ neighbourNode, connection, gCost, GetHeuristicCost(neighbourNode, pGoalNode) + gCost });
-				}
+				});
 
 				
 				for (int i{}; i < int(openList.size()); i++)
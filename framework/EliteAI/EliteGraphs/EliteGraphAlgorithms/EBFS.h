@@ -38,7 +38,7 @@ namespace Elite
 				break;
 			}
 
-			for (auto con : m_pGraph->GetNodeConnections(currenctNode->GetIndex()))
+			m_pGraph->ForEachConnection(currenctNode->GetIndex(), [&](T_ConnectionType* con)
 			{
 				T_NodeType* nextNode = m_pGraph->GetNode(con->GetTo());
 				if (closedList.find(nextNode) == closedList.end())
@@ -46,7 +46,7 @@ namespace Elite
 					openList.push(nextNode);
 					closedList[nextNode] = currenctNode;
 				}
-			}
+			});
 		}
 
 		//Track Back
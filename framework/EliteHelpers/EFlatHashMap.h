@@ -0,0 +1,164 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EFlatHashMap.h: hash map from 64 bit keys to small values, stored in one flat array with
+// linear probing. Unlike std::unordered_map inserting never allocates a node, only growing
+// the array allocates. The all ones key is reserved to mark empty slots. NOT thread safe for
+// writes, concurrent Finds are fine.
+/*=============================================================================*/
+#ifndef ELITE_FLATHASHMAP
+#define ELITE_FLATHASHMAP
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Elite
+{
+	template<class T_Value>
+	class EFlatHashMap final
+	{
+	public:
+		//--- Constructors & Destructors ---
+		EFlatHashMap() = default;
+		~EFlatHashMap() = default;
+
+		//--- Public Functions ---
+		//Returns nullptr when the key is not in the map. The pointer stays valid until the next Insert or Erase.
+		T_Value* Find(uint64_t key)
+		{
+			const size_t slot = FindSlot(key);
+			return slot != NotFound() ? &m_Slots[slot].value : nullptr;
+		}
+		const T_Value* Find(uint64_t key) const
+		{
+			const size_t slot = FindSlot(key);
+			return slot != NotFound() ? &m_Slots[slot].value : nullptr;
+		}
+
+		//Overwrites the value of a key that is already in the map, returns whether the key is new
+		bool Insert(uint64_t key, const T_Value& value)
+		{
+			assert(key != EmptyKey() && "<EFlatHashMap::Insert>: the all ones key is reserved");
+
+			if ((m_Size + 1) * 4 > m_Slots.size() * 3)
+				Rehash(m_Slots.empty() ? 16 : m_Slots.size() * 2);
+
+			size_t slot = GetHomeSlot(key);
+			for (; m_Slots[slot].key != EmptyKey(); slot = (slot + 1) & m_Mask)
+			{
+				if (m_Slots[slot].key == key)
+				{
+					m_Slots[slot].value = value;
+					return false;
+				}
+			}
+
+			m_Slots[slot].key = key;
+			m_Slots[slot].value = value;
+			++m_Size;
+			return true;
+		}
+
+		bool Erase(uint64_t key)
+		{
+			size_t hole = FindSlot(key);
+			if (hole == NotFound())
+				return false;
+
+			//Shift later keys of the same probe run back into the hole, so no tombstones are needed
+			for (size_t slot = (hole + 1) & m_Mask; m_Slots[slot].key != EmptyKey(); slot = (slot + 1) & m_Mask)
+			{
+				const size_t home = GetHomeSlot(m_Slots[slot].key);
+				if (((slot - home) & m_Mask) >= ((slot - hole) & m_Mask))
+				{
+					m_Slots[hole] = m_Slots[slot];
+					hole = slot;
+				}
+			}
+
+			m_Slots[hole].key = EmptyKey();
+			--m_Size;
+			return true;
+		}
+
+		//Makes sure count keys fit without growing the array
+		void Reserve(size_t count)
+		{
+			size_t capacity = 16;
+			while (count * 4 > capacity * 3)
+				capacity *= 2;
+
+			if (capacity > m_Slots.size())
+				Rehash(capacity);
+		}
+
+		//Keeps the array, so refilling the map doesn't allocate
+		void Clear()
+		{
+			for (Slot& slot : m_Slots)
+				slot.key = EmptyKey();
+			m_Size = 0;
+		}
+
+		size_t Size() const { return m_Size; }
+		bool IsEmpty() const { return m_Size == 0; }
+
+	private:
+		//--- Private Types ---
+		struct Slot
+		{
+			uint64_t key;
+			T_Value value;
+		};
+
+		//--- Private Functions ---
+		static uint64_t EmptyKey() { return ~uint64_t(0); }
+		static size_t NotFound() { return ~size_t(0); }
+
+		//Fibonacci hashing, the top bits of the product are spread well even for keys that only differ in the low bits
+		size_t GetHomeSlot(uint64_t key) const { return size_t((key * 0x9E3779B97F4A7C15ull) >> m_Shift); }
+
+		size_t FindSlot(uint64_t key) const
+		{
+			if (m_Size == 0)
+				return NotFound();
+
+			for (size_t slot = GetHomeSlot(key); m_Slots[slot].key != EmptyKey(); slot = (slot + 1) & m_Mask)
+			{
+				if (m_Slots[slot].key == key)
+					return slot;
+			}
+			return NotFound();
+		}
+
+		void Rehash(size_t capacity)
+		{
+			std::vector<Slot> oldSlots(capacity, Slot{ EmptyKey(), T_Value() });
+			oldSlots.swap(m_Slots);
+
+			m_Mask = capacity - 1;
+			m_Shift = 64;
+			for (size_t i = capacity; i > 1; i >>= 1)
+				--m_Shift;
+
+			for (const Slot& oldSlot : oldSlots)
+			{
+				if (oldSlot.key == EmptyKey())
+					continue;
+
+				size_t slot = GetHomeSlot(oldSlot.key);
+				while (m_Slots[slot].key != EmptyKey())
+					slot = (slot + 1) & m_Mask;
+				m_Slots[slot] = oldSlot;
+			}
+		}
+
+		//--- Datamembers ---
+		std::vector<Slot> m_Slots;
+		size_t m_Size = 0;
+		size_t m_Mask = 0;
+		unsigned int m_Shift = 64;
+	};
+}
+#endif
@@ -0,0 +1,109 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// ERadixHeap.h: monotone priority queue for unsigned integer keys. Pushed keys
+// can never be smaller than the last popped key (true for Dijkstra with
+// non-negative costs), which lets every entry move down at most 32 buckets.
+/*=============================================================================*/
+#ifndef ELITE_RADIXHEAP
+#define ELITE_RADIXHEAP
+#include <vector>
+#include <cassert>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Elite
+{
+	template<class T_Value>
+	class ERadixHeap final
+	{
+	public:
+		struct Entry
+		{
+			unsigned int key;
+			T_Value value;
+		};
+
+		//--- Constructors & Destructors ---
+		ERadixHeap() = default;
+		~ERadixHeap() = default;
+
+		//--- Public Functions ---
+		void Push(unsigned int key, const T_Value& value)
+		{
+			assert(key >= m_LastKey && "<ERadixHeap::Push>: key is smaller than the last popped key");
+
+			m_Buckets[GetBucketIndex(key, m_LastKey)].push_back({ key, value });
+			++m_Size;
+		}
+
+		Entry Pop()
+		{
+			assert(m_Size > 0 && "<ERadixHeap::Pop>: heap is empty");
+
+			if (m_Buckets[0].empty())
+			{
+				//Find the first non-empty bucket, its smallest key becomes the new base
+				int bucketIdx = 1;
+				while (m_Buckets[bucketIdx].empty())
+					++bucketIdx;
+
+				std::vector<Entry>& bucket = m_Buckets[bucketIdx];
+				unsigned int minKey = bucket[0].key;
+				for (const Entry& entry : bucket)
+				{
+					if (entry.key < minKey)
+						minKey = entry.key;
+				}
+
+				//Redistribute relative to the new base, every entry lands in a lower bucket
+				m_LastKey = minKey;
+				for (const Entry& entry : bucket)
+					m_Buckets[GetBucketIndex(entry.key, m_LastKey)].push_back(entry);
+				bucket.clear();
+			}
+
+			Entry entry = m_Buckets[0].back();
+			m_Buckets[0].pop_back();
+			--m_Size;
+			return entry;
+		}
+
+		//Empties the heap but keeps the bucket memory around for the next run
+		void Clear()
+		{
+			for (std::vector<Entry>& bucket : m_Buckets)
+				bucket.clear();
+
+			m_LastKey = 0;
+			m_Size = 0;
+		}
+
+		bool IsEmpty() const { return m_Size == 0; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+		//--- Private Functions ---
+		static int GetBucketIndex(unsigned int key, unsigned int lastKey)
+		{
+			//Index of the highest bit that differs from the base, 0 when equal
+			const unsigned int difference = key ^ lastKey;
+			if (difference == 0)
+				return 0;
+#if defined(_MSC_VER)
+			unsigned long highestBit = 0;
+			_BitScanReverse(&highestBit, difference);
+			return int(highestBit) + 1;
+#else
+			return 32 - __builtin_clz(difference);
+#endif
+		}
+
+		//--- Datamembers ---
+		std::vector<Entry> m_Buckets[33];
+		unsigned int m_LastKey = 0;
+		size_t m_Size = 0;
+	};
+}
+#endif
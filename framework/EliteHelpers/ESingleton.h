@@ -20,6 +20,7 @@ namespace Elite
 				m_pInstance = new T();
 			return m_pInstance;
 		};
+		static bool HasInstance() { return m_pInstance != nullptr; }
 		static void Destroy() 
 		{ 
 			delete m_pInstance; 
@@ -0,0 +1,135 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// ESlabAllocator.h: allocates objects of one type from a few large slabs instead of one heap allocation each.
+// Slabs never move, so pointers stay valid until the object is destroyed. Destroyed objects are reused first,
+// every new slab is as large as all previous ones together. NOT thread safe.
+/*=============================================================================*/
+#ifndef ELITE_SLABALLOCATOR
+#define ELITE_SLABALLOCATOR
+#include <functional>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Elite
+{
+	template<class T>
+	class ESlabAllocator final
+	{
+	public:
+		//--- Constructors & Destructors ---
+		explicit ESlabAllocator(unsigned int firstSlabSize = 256)
+			: m_FirstSlabSize(firstSlabSize > 0 ? firstSlabSize : 1)
+		{}
+
+		//Only frees the slabs, the owner destroys the objects still alive before that
+		~ESlabAllocator()
+		{ Release(); }
+
+		ESlabAllocator(const ESlabAllocator&) = delete;
+		ESlabAllocator& operator=(const ESlabAllocator&) = delete;
+
+		//--- Public Functions ---
+		template<class... T_Args>
+		T* Create(T_Args&&... args)
+		{
+			void* pMemory = nullptr;
+			if (!m_FreeUnits.empty())
+			{
+				pMemory = m_FreeUnits.back();
+				m_FreeUnits.pop_back();
+			}
+			else
+			{
+				if (m_Slabs.empty() || m_Slabs.back().used == m_Slabs.back().capacity)
+					AddSlab(m_Slabs.empty() ? m_FirstSlabSize : m_NrOfUnits);
+
+				Slab& slab = m_Slabs.back();
+				pMemory = slab.pUnits + slab.used;
+				++slab.used;
+			}
+
+			return new (pMemory) T(std::forward<T_Args>(args)...);
+		}
+
+		//Calls the destructor, the memory is handed out again by the next Create
+		void Destroy(T* pObject)
+		{
+			if (!pObject)
+				return;
+
+			pObject->~T();
+			m_FreeUnits.push_back(reinterpret_cast<Unit*>(pObject));
+		}
+
+		bool Owns(const T* pObject) const
+		{
+			const Unit* pUnit = reinterpret_cast<const Unit*>(pObject);
+			for (const Slab& slab : m_Slabs)
+			{
+				if (!std::less<const Unit*>()(pUnit, slab.pUnits) && std::less<const Unit*>()(pUnit, slab.pUnits + slab.capacity))
+					return true;
+			}
+			return false;
+		}
+
+		//Makes sure the next count Creates don't allocate, with at most one new slab
+		void Reserve(unsigned int count)
+		{
+			const unsigned int available = static_cast<unsigned int>(m_FreeUnits.size()) + (m_Slabs.empty() ? 0 : m_Slabs.back().capacity - m_Slabs.back().used);
+			if (count > available)
+				AddSlab(count - available);
+		}
+
+		//Frees every slab at once, all objects have to be destroyed (or trivially destructible) already
+		void Release()
+		{
+			for (Slab& slab : m_Slabs)
+				::operator delete(slab.pUnits);
+
+			m_Slabs.clear();
+			m_FreeUnits.clear();
+			m_NrOfUnits = 0;
+		}
+
+		unsigned int GetNrOfSlabs() const { return static_cast<unsigned int>(m_Slabs.size()); }
+
+	private:
+		//--- Private Types ---
+		struct Unit
+		{
+			alignas(T) unsigned char data[sizeof(T)];
+		};
+
+		struct Slab
+		{
+			Unit* pUnits;
+			unsigned int capacity;
+			unsigned int used;
+		};
+
+		//--- Private Functions ---
+		void AddSlab(unsigned int capacity)
+		{
+			//Units left at the end of the current slab stay usable through the free list
+			if (!m_Slabs.empty())
+			{
+				Slab& slab = m_Slabs.back();
+				for (; slab.used < slab.capacity; ++slab.used)
+					m_FreeUnits.push_back(slab.pUnits + slab.used);
+			}
+
+			Unit* pUnits = static_cast<Unit*>(::operator new(sizeof(Unit) * capacity));
+			m_Slabs.push_back(Slab{ pUnits, capacity, 0 });
+			m_NrOfUnits += capacity;
+		}
+
+		//--- Datamembers ---
+		std::vector<Slab> m_Slabs;
+		std::vector<Unit*> m_FreeUnits;
+		unsigned int m_FirstSlabSize;
+		unsigned int m_NrOfUnits = 0;
+	};
+}
+#endif
@@ -0,0 +1,130 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EThreadPool.h: fixed set of worker threads that run parallel for loops.
+// The calling thread helps out and the call returns once every index is done.
+// Calls from different threads are serialized, nested calls are NOT supported.
+/*=============================================================================*/
+#ifndef ELITE_THREADPOOL
+#define ELITE_THREADPOOL
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Elite
+{
+	class EThreadPool final
+	{
+	public:
+		//--- Constructors & Destructors ---
+		//nrOfThreads counts the calling thread, 0 uses every hardware thread
+		explicit EThreadPool(unsigned int nrOfThreads = 0)
+		{
+			if (nrOfThreads == 0)
+				nrOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+			for (unsigned int i = 1; i < nrOfThreads; ++i)
+				m_Workers.emplace_back(&EThreadPool::WorkerLoop, this);
+		}
+
+		~EThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_IsStopping = true;
+			}
+			m_WorkAvailable.notify_all();
+
+			for (std::thread& worker : m_Workers)
+				worker.join();
+		}
+
+		//--- Public Functions ---
+		//Calls job(i) for every i in [0, count), in any order and on any thread
+		void ParallelFor(int count, const std::function<void(int)>& job)
+		{
+			if (count <= 0)
+				return;
+
+			if (m_Workers.empty() || count == 1)
+			{
+				for (int i = 0; i < count; ++i)
+					job(i);
+				return;
+			}
+
+			std::lock_guard<std::mutex> callLock(m_CallMutex);
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_pJob = &job;
+				m_Count = count;
+				m_NextIndex = 0;
+				m_NrOfBusyWorkers = int(m_Workers.size());
+				++m_Generation;
+			}
+			m_WorkAvailable.notify_all();
+
+			RunJobs();
+
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WorkDone.wait(lock, [this]() { return m_NrOfBusyWorkers == 0; });
+			m_pJob = nullptr;
+		}
+
+		//Workers plus the calling thread
+		unsigned int GetNrOfThreads() const { return static_cast<unsigned int>(m_Workers.size()) + 1; }
+
+	private:
+		//--- Private Functions ---
+		void WorkerLoop()
+		{
+			unsigned int seenGeneration = 0;
+			while (true)
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_Mutex);
+					m_WorkAvailable.wait(lock, [&]() { return m_IsStopping || m_Generation != seenGeneration; });
+					if (m_IsStopping)
+						return;
+					seenGeneration = m_Generation;
+				}
+
+				RunJobs();
+
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				if (--m_NrOfBusyWorkers == 0)
+					m_WorkDone.notify_one();
+			}
+		}
+
+		void RunJobs()
+		{
+			int idx;
+			while ((idx = m_NextIndex.fetch_add(1)) < m_Count)
+				(*m_pJob)(idx);
+		}
+
+		//--- Datamembers ---
+		std::vector<std::thread> m_Workers;
+		std::mutex m_Mutex;
+		std::mutex m_CallMutex;
+		std::condition_variable m_WorkAvailable;
+		std::condition_variable m_WorkDone;
+
+		const std::function<void(int)>* m_pJob = nullptr;
+		std::atomic<int> m_NextIndex{ 0 };
+		int m_Count = 0;
+		int m_NrOfBusyWorkers = 0;
+		unsigned int m_Generation = 0;
+		bool m_IsStopping = false;
+
+		//C++ make the class non-copyable
+		EThreadPool(const EThreadPool&) = delete;
+		EThreadPool& operator=(const EThreadPool&) = delete;
+	};
+}
+#endif
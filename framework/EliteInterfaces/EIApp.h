@@ -1,5 +1,18 @@
 #ifndef BASE_APPLICATION_H
 #define BASE_APPLICATION_H
+//-----------------------------------------------------------------
+// Run Settings
+//-----------------------------------------------------------------
+struct AppRunSettings
+{
+	bool isHeadless = false;		//No window, renderer, input or UI
+	bool isDeterministic = false;	//Fixed timestep and seeded rand(), apps avoid anything timing dependent
+	float fixedTimeStep = 1.f / 60.f;
+	unsigned int seed = 1;
+	std::string recordPath;			//Input is recorded to this file when set
+	std::string replayPath;			//Input is played back from this file when set
+};
+
 //-----------------------------------------------------------------
 // Application Base
 //-----------------------------------------------------------------
@@ -15,8 +28,14 @@ public:
 	virtual void Update(float deltaTime) = 0;
 	virtual void Render(float deltaTime) const = 0;
 
+	//Set before Start, headless runs have no window, renderer, input or UI and apps have to leave those alone
+	void SetRunSettings(const AppRunSettings& settings) { m_RunSettings = settings; }
+	const AppRunSettings& GetRunSettings() const { return m_RunSettings; }
+	bool IsHeadless() const { return m_RunSettings.isHeadless; }
+
 protected:
 	//Datamembers
+	AppRunSettings m_RunSettings{};
 
 private:
 	//C++ make the class non-copyable
@@ -20,18 +20,158 @@
 //Hotfix for genetic algorithms project
 bool gRequestShutdown = false;
 
+//Application Creation
+IApp* CreateApp()
+{
+	IApp* myApp = nullptr;
+
+#ifdef Sandbox
+	myApp = new App_Sandbox();
+#endif
+#ifdef FlowFieldApp
+	myApp = new FlowField();
+#endif // FlowField
+
+	ELITE_ASSERT(myApp, "Application has not been created.");
+	return myApp;
+}
+
+//Replays start with a version line followed by "seed <seed>" and "step <seconds>" lines.
+//Returns false when the file can't be read or has neither.
+bool ReadReplayHeader(const string& path, AppRunSettings& settings)
+{
+	std::ifstream file{ path };
+	string line{};
+	if (!std::getline(file, line))
+		return false;
+
+	bool hasSeed{}, hasStep{};
+	string name{};
+	while (!(hasSeed && hasStep) && file >> name)
+	{
+		if (name == "seed" && file >> settings.seed)
+			hasSeed = true;
+		else if (name == "step" && file >> settings.fixedTimeStep)
+			hasStep = true;
+		else if (!std::getline(file, line))
+			break;
+	}
+
+	return hasSeed || hasStep;
+}
+
+//Reads the run mode from the command line, returns false on arguments it doesn't know:
+//--headless, --frames <count>, --step <seconds>, --deterministic, --seed <seed>, --record <file>, --replay <file>
+bool ParseRunSettings(int argc, char* argv[], AppRunSettings& settings, int& nrOfFrames)
+{
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		const string argument{ argv[i] };
+		const bool hasValue{ i + 1 < argc };
+
+		if (argument == "--headless")
+			settings.isHeadless = true;
+		else if (argument == "--deterministic")
+			settings.isDeterministic = true;
+		else if (argument == "--frames" && hasValue)
+			nrOfFrames = stoi(string(argv[++i]));
+		else if (argument == "--step" && hasValue)
+			settings.fixedTimeStep = stof(string(argv[++i]));
+		else if (argument == "--seed" && hasValue)
+			settings.seed = static_cast<unsigned int>(stoul(string(argv[++i])));
+		else if (argument == "--record" && hasValue)
+			settings.recordPath = argv[++i];
+		else if (argument == "--replay" && hasValue)
+			settings.replayPath = argv[++i];
+		else
+			return false;
+	}
+
+	//Recording or replaying only makes sense when the run can be repeated
+	if (!settings.recordPath.empty() || !settings.replayPath.empty())
+		settings.isDeterministic = true;
+
+	//A replay is played back with the seed and timestep it was recorded with
+	if (!settings.replayPath.empty() && !ReadReplayHeader(settings.replayPath, settings))
+		std::cout << "Could not read the header of replay " << settings.replayPath << std::endl;
+
+	return true;
+}
+
+//Runs the application at a fixed timestep without window, renderer or UI.
+//A negative frame count runs until the application requests a shutdown, like at the end of a replay.
+//This is still the windowed executable: it is built with stdafx.h and linked against SDL, Box2D and ImGui, only SDL and ImGui are never started.
+int RunHeadless(const AppRunSettings& settings, int nrOfFrames)
+{
+	try
+	{
+		//Physics isn't booted here, the world only exists once the app creates a body
+		IApp* myApp = CreateApp();
+		myApp->SetRunSettings(settings);
+		myApp->Start();
+
+		const float timeStep{ settings.fixedTimeStep };
+		const auto start = std::chrono::high_resolution_clock::now();
+		int frame{};
+		for (; (nrOfFrames < 0 || frame < nrOfFrames) && !gRequestShutdown; ++frame)
+		{
+			if (PhysicsWorld::HasInstance())
+				PHYSICSWORLD->Simulate(timeStep);
+			myApp->Update(timeStep);
+		}
+		const double elapsedSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		std::cout << "Headless: " << frame << " frames of " << timeStep << " s in " << elapsedSeconds << " s, "
+			<< (elapsedSeconds * 1000.0 / std::max(frame, 1)) << " ms/frame" << std::endl;
+
+		SAFE_DELETE(myApp);
+
+		//The renderer was never initialized, so it isn't shut down either
+		PhysicsWorld::Destroy();
+		Elite::EInputManager::Destroy();
+	}
+	catch (const Elite_Exception& e)
+	{
+		std::cout << e._msg << " Error: " << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
 //Main
 #undef main //Undefine SDL_main as main
 int main(int argc, char* argv[])
 {
 	int x{}, y{};
-	bool runExeWithCoordinates{ argc == 3 };
+	//Window coordinates can be negative on multi monitor setups, so only "--" marks a run setting
+	bool runExeWithCoordinates{ argc == 3 && string(argv[1]).compare(0, 2, "--") != 0 };
+
+	AppRunSettings settings{};
+	int nrOfFrames{};
 
 	if (runExeWithCoordinates)
 	{
 		x = stoi(string(argv[1]));
 		y = stoi(string(argv[2]));
 	}
+	else if (!ParseRunSettings(argc, argv, settings, nrOfFrames))
+	{
+		std::cout << "Usage: [x y] | [--headless] [--frames <count>] [--step <seconds>] [--deterministic] [--seed <seed>] [--record <file>] [--replay <file>]" << std::endl;
+		return 1;
+	}
+
+	//Everything random goes through rand(), one seed makes the whole run repeatable
+	if (settings.isDeterministic)
+		srand(settings.seed);
+
+	if (settings.isHeadless)
+	{
+		//A replay runs until its last frame, anything else for a minute of simulated time by default
+		if (nrOfFrames <= 0)
+			nrOfFrames = settings.replayPath.empty() ? 3600 : -1;
+		return RunHeadless(settings, nrOfFrames);
+	}
 
 	try
 	{
@@ -66,19 +206,8 @@ int main(int argc, char* argv[])
 		TIMER->Start();
 
 		//Application Creation
-		IApp* myApp = nullptr;
-
-#ifdef Sandbox
-		myApp = new App_Sandbox();
-#endif
-#ifdef FlowFieldApp
-		myApp = new FlowField();
-#endif // FlowField
-
-
-
-
-		ELITE_ASSERT(myApp, "Application has not been created.");
+		IApp* myApp = CreateApp();
+		myApp->SetRunSettings(settings);
 
 		//Boot application
 		myApp->Start();
@@ -90,6 +219,9 @@ int main(int argc, char* argv[])
 			TIMER->Update();
 			auto const elapsed = TIMER->GetElapsed();
 
+			//Deterministic runs take one fixed step per frame, no matter how long the frame took
+			auto const timeStep = settings.isDeterministic ? settings.fixedTimeStep : elapsed;
+
 			//Window procedure first, to capture all events and input received by the window
 			if (!pImmediateUI->FocussedOnUI())
 				pWindow->ProcedureEWindow();
@@ -100,9 +232,9 @@ int main(int argc, char* argv[])
 			pImmediateUI->NewFrame(pWindow->GetRawWindowHandle(), elapsed);
 
 			//Update (Physics, App)
-			PHYSICSWORLD->Simulate(elapsed);
+			PHYSICSWORLD->Simulate(timeStep);
 			pCamera->Update();
-			myApp->Update(elapsed);
+			myApp->Update(timeStep);
 
 			//Render and Present Frame
 			PHYSICSWORLD->RenderDebug();
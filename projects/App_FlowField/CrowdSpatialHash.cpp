@@ -0,0 +1,128 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include "CrowdSpatialHash.h"
+
+//Constructor
+CrowdSpatialHash::CrowdSpatialHash(float cellSize)
+	: m_CellSize(cellSize)
+{
+}
+
+//Functions
+void CrowdSpatialHash::Build(const Elite::Vector2* pPositions, int count)
+{
+	m_pPositions = pPositions;
+
+	//Power of two with at least two buckets per agent keeps the buckets short
+	int nrOfBuckets{ 1 };
+	while (nrOfBuckets < count * 2)
+		nrOfBuckets <<= 1;
+	m_BucketMask = nrOfBuckets - 1;
+
+	//Counting sort on the bucket of every agent
+	m_BucketStarts.assign(nrOfBuckets + 1, 0);
+	m_AgentBuckets.resize(count);
+	for (int i{}; i < count; i++)
+	{
+		const int bucket = GetBucket(GetCellCoordinate(pPositions[i].x), GetCellCoordinate(pPositions[i].y));
+		m_AgentBuckets[i] = bucket;
+		++m_BucketStarts[bucket + 1];
+	}
+
+	for (int bucket{}; bucket < nrOfBuckets; bucket++)
+		m_BucketStarts[bucket + 1] += m_BucketStarts[bucket];
+
+	//m_BucketStarts[b + 1] is used as the write cursor of bucket b, it ends at the start of b + 1 again
+	m_SortedAgents.resize(count);
+	for (int i{}; i < count; i++)
+		m_SortedAgents[m_BucketStarts[m_AgentBuckets[i]]++] = i;
+
+	for (int bucket{ nrOfBuckets }; bucket > 0; bucket--)
+		m_BucketStarts[bucket] = m_BucketStarts[bucket - 1];
+	m_BucketStarts[0] = 0;
+}
+
+void CrowdSpatialHash::QueryRadius(const Elite::Vector2& position, float radius, std::vector<int>& agents, int excludeIdx) const
+{
+	agents.clear();
+	if (!m_pPositions || m_SortedAgents.empty())
+		return;
+
+	const int firstCol = GetCellCoordinate(position.x - radius);
+	const int endCol = GetCellCoordinate(position.x + radius) + 1;
+	const int firstRow = GetCellCoordinate(position.y - radius);
+	const int endRow = GetCellCoordinate(position.y + radius) + 1;
+	const float radiusSquared = radius * radius;
+
+	//Different cells can hash to the same bucket, every bucket is only visited once.
+	//Large queries don't fit the list and remove the duplicates afterwards instead.
+	int visitedBuckets[64];
+	int nrOfVisitedBuckets{};
+	bool hasOverflowed{ false };
+
+	for (int row{ firstRow }; row < endRow; row++)
+	{
+		for (int col{ firstCol }; col < endCol; col++)
+		{
+			const int bucket = GetBucket(col, row);
+			if (std::find(visitedBuckets, visitedBuckets + nrOfVisitedBuckets, bucket) != visitedBuckets + nrOfVisitedBuckets)
+				continue;
+			if (nrOfVisitedBuckets < 64)
+				visitedBuckets[nrOfVisitedBuckets++] = bucket;
+			else
+				hasOverflowed = true;
+
+			for (int entry{ m_BucketStarts[bucket] }; entry < m_BucketStarts[bucket + 1]; entry++)
+			{
+				const int agentIdx = m_SortedAgents[entry];
+				if (agentIdx != excludeIdx && Elite::DistanceSquared(m_pPositions[agentIdx], position) <= radiusSquared)
+					agents.push_back(agentIdx);
+			}
+		}
+	}
+
+	if (hasOverflowed)
+	{
+		std::sort(agents.begin(), agents.end());
+		agents.erase(std::unique(agents.begin(), agents.end()), agents.end());
+	}
+}
+
+void CrowdSpatialHash::QueryNearest(const Elite::Vector2& position, int k, float maxRadius, std::vector<int>& agents, int excludeIdx) const
+{
+	agents.clear();
+	if (k <= 0)
+		return;
+
+	//Grow the search one cell at a time until there are enough candidates
+	for (float radius{ m_CellSize }; ; radius += m_CellSize)
+	{
+		const float searchRadius = std::min(radius, maxRadius);
+		QueryRadius(position, searchRadius, agents, excludeIdx);
+		if (int(agents.size()) >= k || searchRadius >= maxRadius)
+			break;
+	}
+
+	auto isCloser = [this, &position](int a, int b)
+	{
+		return Elite::DistanceSquared(m_pPositions[a], position) < Elite::DistanceSquared(m_pPositions[b], position);
+	};
+
+	if (int(agents.size()) > k)
+	{
+		std::partial_sort(agents.begin(), agents.begin() + k, agents.end(), isCloser);
+		agents.resize(k);
+	}
+	else
+	{
+		std::sort(agents.begin(), agents.end(), isCloser);
+	}
+}
+
+int CrowdSpatialHash::GetBucket(int col, int row) const
+{
+	const unsigned int hash = (static_cast<unsigned int>(col) * 73856093u) ^ (static_cast<unsigned int>(row) * 19349663u);
+	return int(hash & static_cast<unsigned int>(m_BucketMask));
+}
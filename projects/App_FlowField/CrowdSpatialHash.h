@@ -0,0 +1,50 @@
+#ifndef FLOWFIELD_CROWDSPATIALHASH_H
+#define FLOWFIELD_CROWDSPATIALHASH_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include <vector>
+
+//-----------------------------------------------------------------
+// Spatial Hash
+//-----------------------------------------------------------------
+// Uniform grid of square cells hashed into a flat bucket table. Build() sorts the
+// agents by bucket with a counting sort, so a rebuild every frame is O(N) and every
+// bucket is one contiguous run of agent indices. Queries are read only and thread safe.
+class CrowdSpatialHash final
+{
+public:
+	//Constructor & Destructor
+	explicit CrowdSpatialHash(float cellSize);
+	~CrowdSpatialHash() = default;
+
+	void Build(const Elite::Vector2* pPositions, int count);
+
+	//Agents within radius of position, excludeIdx is left out (pass the agent doing the query)
+	void QueryRadius(const Elite::Vector2& position, float radius, std::vector<int>& agents, int excludeIdx = -1) const;
+
+	//Up to k nearest agents within maxRadius, sorted from near to far
+	void QueryNearest(const Elite::Vector2& position, int k, float maxRadius, std::vector<int>& agents, int excludeIdx = -1) const;
+
+	float GetCellSize() const { return m_CellSize; }
+
+private:
+	//Datamembers
+	float m_CellSize;
+	int m_BucketMask = 0;
+	const Elite::Vector2* m_pPositions = nullptr;
+
+	//Agents of bucket b are m_SortedAgents[m_BucketStarts[b]] up to m_SortedAgents[m_BucketStarts[b + 1]]
+	std::vector<int> m_BucketStarts;
+	std::vector<int> m_SortedAgents;
+	std::vector<int> m_AgentBuckets;
+
+	//Functions
+	int GetCellCoordinate(float value) const { return int(std::floor(value / m_CellSize)); }
+	int GetBucket(int col, int row) const;
+
+	//C++ make the class non-copyable
+	CrowdSpatialHash(const CrowdSpatialHash&) = delete;
+	CrowdSpatialHash& operator=(const CrowdSpatialHash&) = delete;
+};
+#endif
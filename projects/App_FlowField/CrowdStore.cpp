@@ -0,0 +1,82 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include "CrowdStore.h"
+
+//Functions
+void CrowdStore::Reserve(int nrOfAgents)
+{
+	m_Positions.reserve(nrOfAgents);
+	m_Velocities.reserve(nrOfAgents);
+	m_Orientations.reserve(nrOfAgents);
+	m_Radii.reserve(nrOfAgents);
+	m_GroupIds.reserve(nrOfAgents);
+}
+
+int CrowdStore::AddAgent(const Elite::Vector2& position, float radius, int groupId)
+{
+	m_Positions.push_back(position);
+	m_Velocities.push_back(Elite::ZeroVector2);
+	m_Orientations.push_back(0.f);
+	m_Radii.push_back(radius);
+	m_GroupIds.push_back(groupId);
+
+	return GetNrOfAgents() - 1;
+}
+
+void CrowdStore::Clear()
+{
+	m_Positions.clear();
+	m_Velocities.clear();
+	m_Orientations.clear();
+	m_Radii.clear();
+	m_GroupIds.clear();
+}
+
+void CrowdStore::Integrate(float deltaTime, const FlowFieldGrid& grid, int firstAgent, int endAgent)
+{
+	auto isOpen = [&grid](const Elite::Vector2& position)
+	{
+		const int idx = grid.GetCellIdxAtWorldPos(position);
+		return idx != -1 && grid.IsTraversable(idx);
+	};
+
+	for (int i{ firstAgent }; i < endAgent; i++)
+	{
+		Elite::Vector2& position = m_Positions[i];
+		Elite::Vector2& velocity = m_Velocities[i];
+		const Elite::Vector2 target = position + velocity * deltaTime;
+
+		//An agent that ended up inside a wall is allowed to walk out of it
+		if (isOpen(target) || !isOpen(position))
+		{
+			position = target;
+			continue;
+		}
+
+		if (isOpen({ target.x, position.y }))
+		{
+			position.x = target.x;
+			velocity.y = 0.f;
+		}
+		else if (isOpen({ position.x, target.y }))
+		{
+			position.y = target.y;
+			velocity.x = 0.f;
+		}
+		else
+		{
+			velocity = Elite::ZeroVector2;
+		}
+	}
+}
+
+void CrowdStore::Render() const
+{
+	for (int i{}; i < GetNrOfAgents(); i++)
+	{
+		DEBUGRENDERER2D->DrawSolidCircle(m_Positions[i], m_Radii[i], { 0, 0 }, { 1, 1, 0, 1 });
+		DEBUGRENDERER2D->DrawDirection(m_Positions[i], Elite::OrientationToVector(m_Orientations[i]), m_Radii[i], { 0, 0, 0, 1 });
+	}
+}
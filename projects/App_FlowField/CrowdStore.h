@@ -0,0 +1,58 @@
+#ifndef FLOWFIELD_CROWDSTORE_H
+#define FLOWFIELD_CROWDSTORE_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include <vector>
+#include "FlowFieldGrid.h"
+
+//-----------------------------------------------------------------
+// Crowd Store
+//-----------------------------------------------------------------
+// Agents as plain data: every attribute lives in its own contiguous array and an
+// agent is an index into them. There are no per-agent objects or physics bodies,
+// walls are handled against the cost field of the grid instead.
+class CrowdStore final
+{
+public:
+	//Constructor & Destructor
+	CrowdStore() = default;
+	~CrowdStore() = default;
+
+	void Reserve(int nrOfAgents);
+	int AddAgent(const Elite::Vector2& position, float radius = 1.f, int groupId = 0);
+	void Clear();
+
+	int GetNrOfAgents() const { return int(m_Positions.size()); }
+
+	//Attribute arrays, all the same length
+	std::vector<Elite::Vector2>& GetPositions() { return m_Positions; }
+	const std::vector<Elite::Vector2>& GetPositions() const { return m_Positions; }
+	std::vector<Elite::Vector2>& GetVelocities() { return m_Velocities; }
+	const std::vector<Elite::Vector2>& GetVelocities() const { return m_Velocities; }
+	std::vector<float>& GetOrientations() { return m_Orientations; }
+	const std::vector<float>& GetOrientations() const { return m_Orientations; }
+	const std::vector<float>& GetRadii() const { return m_Radii; }
+	std::vector<int>& GetGroupIds() { return m_GroupIds; }
+	const std::vector<int>& GetGroupIds() const { return m_GroupIds; }
+
+	//Moves the agents in [firstAgent, endAgent) along their velocity, a step into a wall or out
+	//of the grid slides along the blocked axis. Ranges don't share data, so they can run in parallel.
+	void Integrate(float deltaTime, const FlowFieldGrid& grid, int firstAgent, int endAgent);
+	void Integrate(float deltaTime, const FlowFieldGrid& grid) { Integrate(deltaTime, grid, 0, GetNrOfAgents()); }
+
+	void Render() const;
+
+private:
+	//Datamembers
+	std::vector<Elite::Vector2> m_Positions;
+	std::vector<Elite::Vector2> m_Velocities;
+	std::vector<float> m_Orientations;
+	std::vector<float> m_Radii;
+	std::vector<int> m_GroupIds;
+
+	//C++ make the class non-copyable
+	CrowdStore(const CrowdStore&) = delete;
+	CrowdStore& operator=(const CrowdStore&) = delete;
+};
+#endif
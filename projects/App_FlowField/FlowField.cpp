@@ -3,53 +3,92 @@
 
 //Includes
 #include "FlowField.h"
-#include "projects/Shared/BaseAgent.h"
-#include "projects/Shared/NavigationColliderElement.h"
-#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAstar.h"
-#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EBFS.h"
 
 using namespace Elite;
 
 //Destructor
 FlowField::~FlowField()
 {
-	SAFE_DELETE(m_pGridGraph);
-	SAFE_DELETE(m_pIntegrationField);
-
-	for (BaseAgent* agent : m_Agents)
+	if (m_IsRecording)
 	{
-		delete agent;
-		agent = nullptr;
+		if (m_Replay.Save(GetRunSettings().recordPath, m_FrameNr))
+			std::cout << "Recorded " << m_FrameNr << " frames to " << GetRunSettings().recordPath << std::endl;
+		else
+			std::cout << "Could not write replay " << GetRunSettings().recordPath << std::endl;
 	}
 
-	for (NavigationColliderElement* wall : m_Walls)
-	{
-		delete wall;
-		wall = nullptr;
-	}
+	if (m_IsReplaying)
+		std::cout << "Replayed " << m_FrameNr << " frames, " << m_Replay.GetNrOfMismatches() << " goal mismatches" << std::endl;
+
+	SAFE_DELETE(m_pFieldGrid);
+	SAFE_DELETE(m_pBuilder);
+	SAFE_DELETE(m_pIntegrator);
+	SAFE_DELETE(m_pThreadPool);
+	SAFE_DELETE(m_pSectorMap);
+	SAFE_DELETE(m_pFieldCache);
+	SAFE_DELETE(m_pDensity);
+	SAFE_DELETE(m_pGroups);
 }
 
 //Functions
 void FlowField::Start()
 {
 	//Set Camera
-	DEBUGRENDERER2D->GetActiveCamera()->SetZoom(39.0f);
-	DEBUGRENDERER2D->GetActiveCamera()->SetCenter(Elite::Vector2(73.0f, 35.0f));
+	if (!IsHeadless())
+	{
+		DEBUGRENDERER2D->GetActiveCamera()->SetZoom(39.0f);
+		DEBUGRENDERER2D->GetActiveCamera()->SetCenter(Elite::Vector2(73.0f, 35.0f));
+	}
 
-	//Create Graph
-	MakeGridGraph();
+	StartRecordOrReplay();
+
+	//Create Grid
+	MakeFieldGrid();
 	//CreateCostField();
 	CalculateFlowField();
 
-	CreateBoundaries();
-	CreateAgents(50.f);
+	CreateAgents(m_NrOfAgents);
 }
 
 void FlowField::Update(float deltaTime)
 {
-	UNREFERENCED_PARAMETER(deltaTime);
+	//A replay always steps like the recording did
+	if (m_IsReplaying)
+		deltaTime = m_Replay.GetTimeStep();
+
+	PollAsyncRebuild();
 
 	//INPUT
+	if (m_IsReplaying)
+		ApplyReplayInput();
+	else if (!IsHeadless())
+		HandleInput();
+
+	//The density layer only has to follow the crowd roughly, so it isn't refreshed every frame
+	if (m_UseDensity && ++m_FramesSinceDensity >= m_DensityInterval)
+	{
+		m_FramesSinceDensity = 0;
+		UpdateDensityCosts();
+	}
+
+	//Picks up goal and cost changes of the other groups, nothing is built when none happened
+	UpdateGroupFields();
+
+	const auto agentsStart = std::chrono::high_resolution_clock::now();
+	UpdateAgents(deltaTime);
+	m_AgentUpdateMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - agentsStart).count();
+
+	++m_FrameNr;
+	if (m_IsReplaying && IsHeadless() && m_Replay.IsFinished(m_FrameNr))
+		gRequestShutdown = true;
+
+	//IMGUI
+	if (!IsHeadless())
+		UpdateImGui();
+}
+
+void FlowField::HandleInput()
+{
 	//bool const middleMousePressed = INPUTMANAGER->IsMouseButtonUp(InputMouseButton::eMiddle);
 	//if (middleMousePressed)
 	//{
@@ -63,12 +102,10 @@ void FlowField::Update(float deltaTime)
 		MouseData mouseData = { INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eLeft) };
 		Elite::Vector2 mousePos = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld({ (float)mouseData.X, (float)mouseData.Y });
 
-		auto clickedNode = m_pGridGraph->GetNodeAtWorldPos(mousePos);
+		int clickedIdx = m_pFieldGrid->GetCellIdxAtWorldPos(mousePos);
 
-		if (clickedNode)
-			m_GoalNodeIdx = clickedNode->GetIndex();
-
-		CalculateFlowField();
+		if (clickedIdx != -1)
+			SetGoal(clickedIdx);
 	}
 
 	bool const rightMousePressed = INPUTMANAGER->IsMouseButtonUp(InputMouseButton::eMiddle);
@@ -77,342 +114,740 @@ void FlowField::Update(float deltaTime)
 		MouseData mouseData = { INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eMiddle) };
 		Elite::Vector2 mousePos = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld({ (float)mouseData.X, (float)mouseData.Y });
 
-		auto clickedNode = m_pGridGraph->GetNodeAtWorldPos(mousePos);
+		int clickedIdx = m_pFieldGrid->GetCellIdxAtWorldPos(mousePos);
 
-		if (clickedNode)
-		{
-			MakeNotTraversable(clickedNode->GetIndex());
-			CalculateFlowField();
-		}
+		if (clickedIdx != -1)
+			PlaceWall(clickedIdx);
 	}
+}
 
-	for (BaseAgent* agent : m_Agents)
+void FlowField::StartRecordOrReplay()
+{
+	//The seed and timestep are set up by main, a replay brings its own seed, timestep and number of agents
+	const AppRunSettings& settings = GetRunSettings();
+	if (!settings.replayPath.empty())
 	{
-		auto agentNode = m_pGridGraph->GetNodeAtWorldPos(agent->GetPosition());
-		Vector2 velocity{};
-
-		if (agentNode)
+		m_IsReplaying = m_Replay.Load(settings.replayPath);
+		if (!m_IsReplaying)
 		{
-			velocity = agentNode->GetDirection() * m_AgentSpeed;
-
-			if (velocity == ZeroVector2)
-			{
-				velocity = agent->GetLinearVelocity();
-			}
-
+			std::cout << "Could not read replay " << settings.replayPath << std::endl;
+			return;
+		}
 
-			if (agentNode->GetCost() >= m_NonTraversable)
-			{
-				Vector2 NodePosition{ m_pGridGraph->GetNodePos(agentNode) * float(m_SizeCell) };
-				NodePosition.x += float(m_SizeCell) / 2.f;
-				NodePosition.y += float(m_SizeCell) / 2.f;
+		//Reseeded here, before the grid and agents are made, main seeded the recording at the same point
+		m_NrOfAgents = m_Replay.GetNrOfAgents();
+		m_RunSettings.seed = m_Replay.GetSeed();
+		m_RunSettings.fixedTimeStep = m_Replay.GetTimeStep();
+		srand(m_Replay.GetSeed());
+	}
+	else if (!settings.recordPath.empty())
+	{
+		m_IsRecording = true;
+		m_Replay.StartRecording(settings.seed, settings.fixedTimeStep, m_NrOfAgents);
+	}
+}
 
-				velocity = agent->GetPosition() - NodePosition;
-				velocity = velocity.GetNormalized();
-				velocity *= m_AgentSpeed;
-			}
+void FlowField::ApplyReplayInput()
+{
+	ReplayEvent event{};
+	while (m_Replay.PopInputEvent(m_FrameNr, event))
+	{
+		if (event.type == ReplayEventType::Goal)
+			SetGoal(event.cellIdx);
+		else if (event.type == ReplayEventType::Wall)
+			PlaceWall(event.cellIdx);
+	}
+}
 
-			//agent->SetLinearVelocity(velocity);
-			float angle = Elite::GetOrientationFromVelocity(velocity);
-			agent->SetRotation(angle - (float(M_PI) / 2.f));
-			agent->SetLinearVelocity(Elite::Lerp(agent->GetLinearVelocity(), velocity, 0.5f));
-			agent->Update(deltaTime);
+void FlowField::RecordEvent(ReplayEventType type, int groupId, int nodeIdx)
+{
+	if (m_IsRecording)
+		m_Replay.Record({ m_FrameNr, type, groupId, nodeIdx });
+	else if (m_IsReplaying && type == ReplayEventType::Retarget)
+		m_Replay.CheckRetarget({ m_FrameNr, type, groupId, nodeIdx });
+}
 
-			if (agentNode->GetIndex() == m_GoalNodeIdx)
-			{
-				int randomNr = rand() % (COLUMNS * ROWS);
+void FlowField::SetGoal(int nodeIdx)
+{
+	RecordEvent(ReplayEventType::Goal, 0, nodeIdx);
 
-				auto randomNode = m_pGridGraph->GetNode(randomNr);
-				while (randomNode->GetCost() >= m_NonTraversable)
-				{
-					randomNr = rand() % (COLUMNS * ROWS);
-					randomNode = m_pGridGraph->GetNode(randomNr);
-				}
+	m_GoalNodeIdx = nodeIdx;
+	CalculateFlowField();
+}
 
-				m_GoalNodeIdx = randomNr;
-				CalculateFlowField();
-			}
-		}
-	}
+void FlowField::PlaceWall(int nodeIdx)
+{
+	RecordEvent(ReplayEventType::Wall, 0, nodeIdx);
 
-	//IMGUI
-	UpdateImGui();
+	//Clicking a wall again changes nothing, bumping the cost version for it would throw away every cached field
+	int oldCost{ GetPathCosts()[nodeIdx] };
+	if (MakeNotTraversable(nodeIdx))
+		RepairFlowField(nodeIdx, oldCost);
 }
 
 void FlowField::Render(float deltaTime) const
 {
 	UNREFERENCED_PARAMETER(deltaTime);
 	//Render grid
-	m_GraphRenderer.RenderGraph(
-		m_pGridGraph,
-		m_bDrawGrid,
-		m_bDrawNodeNumbers,
-		m_bDrawConnections,
-		m_bDrawConnectionsCosts
-	);
+	if (m_bDrawGrid)
+	{
+		const float halfSize{ float(m_SizeCell) / 2.f };
+		for (int idx{}; idx < m_pFieldGrid->GetNrOfCells(); idx++)
+		{
+			Vector2 cellPos{ m_pFieldGrid->GetCellWorldPos(idx) };
+			Vector2 verts[4]
+			{
+				Vector2(cellPos.x - halfSize, cellPos.y - halfSize),
+				Vector2(cellPos.x - halfSize, cellPos.y + halfSize),
+				Vector2(cellPos.x + halfSize, cellPos.y + halfSize),
+				Vector2(cellPos.x + halfSize, cellPos.y - halfSize)
+			};
 
+			DEBUGRENDERER2D->DrawPolygon(&verts[0], 4, DEFAULT_NODE_COLOR, 0.0f);
+			DEBUGRENDERER2D->DrawSolidPolygon(&verts[0], 4, DEFAULT_NODE_COLOR, 0.1f);
 
+			if (m_bDrawNodeNumbers)
+				DEBUGRENDERER2D->DrawString(cellPos + Vector2{ -0.5f, 1.f }, std::to_string(idx).c_str());
+		}
+	}
 
 	if (m_DrawGoal)
 	{
 		Vector2 nodePos = GetNodePosition(m_GoalNodeIdx);
 		DEBUGRENDERER2D->DrawCircle(nodePos, 4.f, { 1, 0, 1 }, 0.f);
-	}
-
 
+		for (int groupId{ 1 }; groupId < m_NrOfGroups; groupId++)
+			DEBUGRENDERER2D->DrawCircle(GetNodePosition(m_pGroups->GetGoal(groupId)), 3.f, { 0, 1, 1 }, 0.f);
+	}
 
-	auto nodes = m_pGridGraph->GetAllNodes();
+	if (m_DrawAgents)
+		m_Crowd.Render();
 
 	for (int i{}; i < ROWS; i++)
 	{
 		for (int j{}; j < COLUMNS; j++)
 		{
-			Vector2 position{ j * m_SizeCell + (m_SizeCell / 2.f), i * m_SizeCell + (m_SizeCell / 2.f) };
+			const int idx{ m_pFieldGrid->GetIndex(j, i) };
+			Vector2 position{ m_pFieldGrid->GetCellWorldPos(idx) };
 			Vector2 positionBL{ float(j * m_SizeCell), float(i * m_SizeCell) + 2.f};
-			auto node = m_pGridGraph->GetNodeAtWorldPos(position);
-			int intCost{ m_pIntegrationField->GetNode(node->GetIndex())->GetIntegrationCost() };
-			int Cost{ m_pGridGraph->GetNode(node->GetIndex())->GetCost() };
+			//The flat layer is left over from before hierarchical mode, the sectors have their own integration
+			int intCost{ m_UseSectors ? m_pSectorMap->GetBuiltIntegration(idx) : m_pActiveLayer->integration[idx] };
+			int Cost{ GetPathCosts()[idx] };
 
-			if (m_DrawIntegrationCosts)
+			if (m_DrawIntegrationCosts && intCost != -1)
 				DEBUGRENDERER2D->DrawString(positionBL, std::to_string(intCost).c_str());
 
 			if (m_DrawCosts)
-				DEBUGRENDERER2D->DrawString(positionBL, std::to_string(intCost).c_str());
+				DEBUGRENDERER2D->DrawString(positionBL, std::to_string(Cost).c_str());
+
+			if (m_DrawLineOfSight && GetLineOfSight()[idx])
+				DEBUGRENDERER2D->DrawCircle(position, 1.f, { 1, 1, 0 }, 0.f);
 
 			if (m_DrawVectors)
 			{
+				//Hierarchical mode only shows the sectors that were built so far
+				Vector2 direction{ m_UseSectors ? m_pSectorMap->GetBuiltDirection(idx) : FlowFieldGrid::UnpackDirection(m_pActiveLayer->directions[idx]) };
 				DEBUGRENDERER2D->DrawPoint(position, 2.f, { 1, 0, 0 }, 0);
-				DEBUGRENDERER2D->DrawDirection(position, node->GetDirection(), 3.f, { 0, 1, 0 });
+				DEBUGRENDERER2D->DrawDirection(position, direction, 3.f, { 0, 1, 0 });
 			}
 
 		}
 	}
 }
 
-void FlowField::MakeGridGraph()
+void FlowField::MakeFieldGrid()
 {
-	m_pGridGraph = new GridGraph<FlowFieldNode, GraphConnection>(COLUMNS, ROWS, m_SizeCell, false, true, 1.f, 2.f);
-	m_pIntegrationField = new GridGraph<IntegrationFieldNode, GraphConnection>(COLUMNS, ROWS, m_SizeCell, false, true, 1.f, 2.f);
+	m_pFieldGrid = new FlowFieldGrid(COLUMNS, ROWS, float(m_SizeCell));
+	m_pIntegrator = new FlowFieldIntegrator(COLUMNS, ROWS, true, 1, 2, m_NonTraversable);
+	m_pThreadPool = new EThreadPool();
+	//The builder gets half the threads of its own, so a background build and the agent update don't wait on each other
+	m_pBuilder = new FlowFieldBuilder(COLUMNS, ROWS, true, 1, 2, m_NonTraversable, m_pThreadPool->GetNrOfThreads() / 2);
+	m_pSectorMap = new FlowFieldSectorMap(COLUMNS, ROWS, SECTOR_SIZE, true, 1, 2, m_NonTraversable);
+	m_pFieldCache = new FlowFieldCache(size_t(m_CacheBudgetKB) * 1024);
+	m_pDensity = new FlowFieldDensity(COLUMNS, ROWS, float(m_SizeCell));
+	m_pGroups = new FlowFieldGroups(COLUMNS, ROWS, true, 1, 2, m_NonTraversable);
+	m_pGroups->SetNrOfGroups(m_NrOfGroups);
 
 	m_GoalNodeIdx = (COLUMNS * ROWS) - 1;
 }
 
 void FlowField::CalculateFlowField()
 {
+	if (m_UseSectors)
+	{
+		CalculateSectorFlowField();
+		return;
+	}
+
+	//A goal that was seen before on the same cost field is only a pointer swap
+	const FlowFieldKey key{ m_GoalNodeIdx, m_CostVersion, int(m_IntegrationMode) };
+	auto pCachedLayer = m_pFieldCache->Find(key);
+	if (pCachedLayer)
+	{
+		m_pActiveLayer = pCachedLayer;
+		m_IsActiveLayerInGraph = false;
+		m_IsRebuildPending = false;
+		return;
+	}
+
+	//Every request in a frame replaces the previous one, the builder only runs the newest.
+	//When a build finishes depends on timing, so deterministic runs always build right away.
+	if (m_UseAsyncRebuild && !GetRunSettings().isDeterministic)
+	{
+		m_pBuilder->Request(key, m_IntegrationMode, GetPathCosts(), m_UseThreads);
+		m_RequestedKey = key;
+		m_IsRebuildPending = true;
+		m_IsActiveLayerInGraph = false;
+		return;
+	}
+
+	m_IsRebuildPending = false;
+
 	CalculateIntegrationField();
 	CalculateVectors();
 
-	auto nodes = m_pGridGraph->GetAllNodes();
-
-	for (int i{}; i < nodes.size(); i++)
+	for (int i{}; i < m_pFieldGrid->GetNrOfCells(); i++)
 	{
-		if (nodes[i]->GetCost() == m_NonTraversable)
+		if (m_pFieldGrid->GetCost(i) == m_NonTraversable)
 		{
-			nodes[i]->SetDirection({ 0, 0 });
+			m_pFieldGrid->SetDirection(i, { 0, 0 });
 		}
 	}
 
-	m_pGridGraph->GetNode(m_GoalNodeIdx)->SetDirection({ 0, 0 });
+	m_pFieldGrid->SetDirection(m_GoalNodeIdx, { 0, 0 });
+	CalculateLineOfSight();
+
+	StoreActiveLayer();
 }
 
-void FlowField::CreateCostField()
+void FlowField::PollAsyncRebuild()
 {
-	m_pGridGraph->GetNode(45)->SetCost(20001);
+	FlowFieldKey key{};
+	std::shared_ptr<const FlowFieldLayer> pLayer{};
+	if (!m_pBuilder->TakeResult(key, pLayer))
+		return;
+
+	//Layers built on an older cost field are outdated, an older goal is still worth caching
+	if (key.costVersion == m_CostVersion)
+		m_pFieldCache->Insert(key, pLayer);
+
+	if (m_IsRebuildPending && key == m_RequestedKey)
+	{
+		m_pActiveLayer = pLayer;
+		m_IsActiveLayerInGraph = false;
+		m_IsRebuildPending = false;
+	}
 }
 
-void FlowField::CalculateIntegrationField()
+void FlowField::StoreActiveLayer()
 {
-	//Dijkstra();
-	BFS();
+	auto pLayer = std::make_shared<FlowFieldLayer>();
+	pLayer->integration = m_pFieldGrid->GetIntegration();
+	pLayer->directions = m_pFieldGrid->GetDirections();
+	pLayer->lineOfSight = m_pFieldGrid->GetLineOfSight();
+	pLayer->goalIdx = m_GoalNodeIdx;
+
+	m_pActiveLayer = pLayer;
+	m_IsActiveLayerInGraph = true;
+	m_pFieldCache->Insert({ m_GoalNodeIdx, m_CostVersion, int(m_IntegrationMode) }, m_pActiveLayer);
 }
 
-void FlowField::Dijkstra()
+void FlowField::RepairFlowField(int nodeIdx, int oldCost)
 {
-	//Set total cost in all cells to 65535
-	ResetField();
-	std::list<int> openList{};
+	//Only the Dijkstra field is exact enough to be repaired locally
+	//A layer that came from the cache doesn't match the graph, so it can't be repaired either
+	if (m_UseSectors || m_IntegrationMode != IntegrationMode::Dijkstra || !m_IsActiveLayerInGraph)
+	{
+		CalculateFlowField();
+		return;
+	}
 
-	IntegrationFieldNode* goalNode = m_pIntegrationField->GetNode(m_GoalNodeIdx);
-	goalNode->SetIntegrationCost(0);
-	openList.push_back(m_GoalNodeIdx);
+	if (!m_pIntegrator->RepairDijkstra(GetPathCosts(), m_GoalNodeIdx, nodeIdx, oldCost, m_pFieldGrid->GetIntegration(), m_ChangedCells))
+	{
+		CalculateFlowField();
+		return;
+	}
 
-	while (openList.size() > 0)
+	//Directions change for the repaired cells and the cells that look at them
+	m_ChangedCells.push_back(nodeIdx);
+	for (int changedIdx : m_ChangedCells)
 	{
-		int currentIdx = openList.front();
-		IntegrationFieldNode* currentNode = m_pIntegrationField->GetNode(currentIdx);
-		openList.pop_front();
+		const int col{ changedIdx % COLUMNS };
+		const int row{ changedIdx / COLUMNS };
 
-		auto neighbours = m_pGridGraph->GetConnections(currentIdx);
-		int neighbourCount = neighbours.size();
+		for (int neighbourRow{ row - 1 }; neighbourRow <= row + 1; neighbourRow++)
+		{
+			for (int neighbourCol{ col - 1 }; neighbourCol <= col + 1; neighbourCol++)
+			{
+				if (m_pFieldGrid->IsWithinBounds(neighbourCol, neighbourRow))
+					UpdateVector(m_pFieldGrid->GetIndex(neighbourCol, neighbourRow));
+			}
+		}
+	}
+	CalculateLineOfSight();
+	StoreActiveLayer();
+}
+
+void FlowField::CalculateSectorFlowField()
+{
+	//Portals only depend on the costs, a goal change just reruns the portal search
+	if (m_PortalsDirty)
+	{
+		m_pSectorMap->BuildPortals(GetPathCosts());
+		m_PortalsDirty = false;
+	}
+
+	m_pSectorMap->SetGoal(m_GoalNodeIdx);
+	CalculateLineOfSight();
+}
+
+const std::vector<uint8_t>& FlowField::GetPathCosts() const
+{
+	return m_UseDensity ? m_pDensity->GetCosts() : m_pFieldGrid->GetCosts();
+}
 
-		for (const auto& neighbour : neighbours)
+const std::vector<uint8_t>& FlowField::GetLineOfSight() const
+{
+	return m_UseSectors ? m_pFieldGrid->GetLineOfSight() : m_pActiveLayer->lineOfSight;
+}
+
+void FlowField::CalculateLineOfSight()
+{
+	m_pIntegrator->CalculateLineOfSight(GetPathCosts(), m_GoalNodeIdx, m_pFieldGrid->GetLineOfSight());
+}
+
+void FlowField::UpdateDensityCosts()
+{
+	m_pDensity->Splat(m_Crowd.GetPositions().data(), m_Crowd.GetNrOfAgents());
+	if (!m_pDensity->ApplyToCosts(m_pFieldGrid->GetCosts(), m_DensityWeight, m_MinDensity))
+		return;
+
+	//Every density change is a new cost field, fields of older versions age out of the cache
+	++m_CostVersion;
+	m_PortalsDirty = true;
+	CalculateFlowField();
+}
+
+void FlowField::UpdateAgents(float deltaTime)
+{
+	const int nrOfAgents{ m_Crowd.GetNrOfAgents() };
+	const int nrOfChunks{ (nrOfAgents + AGENT_CHUNK_SIZE - 1) / AGENT_CHUNK_SIZE };
+	auto runChunks = [this, nrOfChunks](const std::function<void(int)>& job)
+	{
+		if (m_UseThreads)
 		{
-			FlowFieldNode* neighbourFlowNode = m_pGridGraph->GetNode(neighbour->GetTo());
-			IntegrationFieldNode* neighbourNode = m_pIntegrationField->GetNode(neighbour->GetTo());
+			m_pThreadPool->ParallelFor(nrOfChunks, job);
+			return;
+		}
 
-			int endNodeCost{ currentNode->GetIntegrationCost() + neighbourFlowNode->GetCost() };
+		for (int chunk{}; chunk < nrOfChunks; chunk++)
+			job(chunk);
+	};
 
-			if (endNodeCost > neighbourFlowNode->GetCost())
-				endNodeCost -= 1;
+	//Sector fields are built on first use, that has to happen before the agents read them in parallel
+	if (m_UseSectors)
+	{
+		m_ChunkSectors.resize(nrOfChunks);
+		runChunks([this, nrOfAgents](int chunk)
+		{
+			std::vector<int>& sectors = m_ChunkSectors[chunk];
+			sectors.clear();
 
-			if (endNodeCost < neighbourNode->GetIntegrationCost())
+			const int endAgent{ std::min((chunk + 1) * AGENT_CHUNK_SIZE, nrOfAgents) };
+			for (int i{ chunk * AGENT_CHUNK_SIZE }; i < endAgent; i++)
 			{
-				if (std::find(openList.begin(), openList.end(), neighbourNode->GetIndex()) == openList.end())
-				{
-					openList.push_back(neighbourNode->GetIndex());
-				}
+				int agentIdx = m_pFieldGrid->GetCellIdxAtWorldPos(m_Crowd.GetPositions()[i]);
+				if (agentIdx != -1 && !m_pSectorMap->IsSectorBuilt(m_pSectorMap->GetSectorIdx(agentIdx)))
+					sectors.push_back(m_pSectorMap->GetSectorIdx(agentIdx));
 			}
+		});
 
-			neighbourNode->SetIntegrationCost(endNodeCost);
+		for (const std::vector<int>& sectors : m_ChunkSectors)
+		{
+			for (int sectorIdx : sectors)
+				m_pSectorMap->BuildSector(sectorIdx);
 		}
 	}
+
+	//Rebuilt every frame, the parallel pass below only reads it
+	if (m_UseSteering)
+		m_CrowdHash.Build(m_Crowd.GetPositions().data(), nrOfAgents);
+
+	m_AgentDirections.resize(nrOfAgents);
+	m_ChunkReachedGoal.assign(nrOfChunks * m_NrOfGroups, 0);
+	runChunks([this, nrOfAgents](int chunk)
+	{
+		UpdateAgentRange(chunk * AGENT_CHUNK_SIZE, std::min((chunk + 1) * AGENT_CHUNK_SIZE, nrOfAgents), &m_ChunkReachedGoal[chunk * m_NrOfGroups]);
+	});
+
+	//Side effects of the parallel part, one new goal per group no matter how many agents reached the old one
+	bool hasNewGroupGoals{ false };
+	for (int groupId{}; groupId < m_NrOfGroups; groupId++)
+	{
+		bool hasReachedGoal{ false };
+		for (int chunk{}; chunk < nrOfChunks && !hasReachedGoal; chunk++)
+			hasReachedGoal = m_ChunkReachedGoal[chunk * m_NrOfGroups + groupId] != 0;
+
+		if (!hasReachedGoal)
+			continue;
+
+		const int goalIdx{ GetRandomOpenNode() };
+		RecordEvent(ReplayEventType::Retarget, groupId, goalIdx);
+
+		if (groupId == 0)
+		{
+			m_GoalNodeIdx = goalIdx;
+			CalculateFlowField();
+		}
+		else
+		{
+			m_pGroups->SetGoal(groupId, goalIdx);
+			hasNewGroupGoals = true;
+		}
+	}
+
+	//All new group goals are built in one batch
+	if (hasNewGroupGoals)
+		UpdateGroupFields();
+
+	runChunks([this, nrOfAgents, deltaTime](int chunk)
+	{
+		m_Crowd.Integrate(deltaTime, *m_pFieldGrid, chunk * AGENT_CHUNK_SIZE, std::min((chunk + 1) * AGENT_CHUNK_SIZE, nrOfAgents));
+	});
 }
 
-void FlowField::BFS()
+void FlowField::UpdateAgentRange(int firstAgent, int endAgent, char* pReachedGoals)
 {
-	ResetField();
-	IntegrationFieldNode* pDestinationNode = m_pIntegrationField->GetNode(m_GoalNodeIdx);
-
-	//Caclulate path using BFS
-	std::list<IntegrationFieldNode*> openList;
-	std::list<IntegrationFieldNode*> closedList;
+	std::vector<Vector2>& positions = m_Crowd.GetPositions();
+	std::vector<Vector2>& velocities = m_Crowd.GetVelocities();
+	std::vector<float>& orientations = m_Crowd.GetOrientations();
+	const std::vector<int>& groupIds = m_Crowd.GetGroupIds();
+
+	//Bilinear sampling gives smooth directions, with a single group the whole range is sampled in one go
+	const bool isBatchSampled{ m_UseBilinearSampling && !m_UseSectors && m_NrOfGroups == 1 };
+	if (isBatchSampled)
+	{
+		m_pFieldGrid->SampleDirections(m_pActiveLayer->directions, positions.data() + firstAgent, m_AgentDirections.data() + firstAgent, endAgent - firstAgent);
+	}
 
-	openList.push_back(pDestinationNode);
-	pDestinationNode->SetIntegrationCost(0);
+	std::vector<int> neighbours;
+	neighbours.reserve(NEIGHBOUR_COUNT);
 
-	while (!openList.empty())
+	for (int i{ firstAgent }; i < endAgent; i++)
 	{
-		IntegrationFieldNode* currenctNode = openList.front();
-		FlowFieldNode* flowCurrenctNode = m_pGridGraph->GetNode(currenctNode->GetIndex());
-		openList.pop_front();
+		int agentIdx = m_pFieldGrid->GetCellIdxAtWorldPos(positions[i]);
+		Vector2 velocity{};
 
-		for (auto con : m_pIntegrationField->GetNodeConnections(currenctNode->GetIndex()))
+		if (agentIdx != -1)
 		{
-			IntegrationFieldNode* nextNode = m_pIntegrationField->GetNode(con->GetTo());
-			FlowFieldNode* flowNextNode = m_pGridGraph->GetNode(nextNode->GetIndex());
+			//Only the hierarchical field of group 0 has no layer
+			const int groupId{ groupIds[i] };
+			const FlowFieldLayer* pLayer{ GetGroupLayer(groupId) };
+			const bool isSectorField{ groupId == 0 && m_UseSectors };
+			const bool isSampled{ m_UseBilinearSampling && pLayer };
+
+			if (isBatchSampled)
+				velocity = m_AgentDirections[i] * m_AgentSpeed;
+			else if (isSampled)
+				velocity = m_pFieldGrid->SampleDirection(pLayer->directions, positions[i]) * m_AgentSpeed;
+			else if (pLayer)
+				velocity = FlowFieldGrid::UnpackDirection(pLayer->directions[agentIdx]) * m_AgentSpeed;
+			else if (isSectorField)
+				velocity = m_pSectorMap->GetBuiltDirection(agentIdx) * m_AgentSpeed;
+
+			//The field that is followed can still be the one of the previous goal while a new one is built
+			const int fieldGoalIdx{ pLayer ? pLayer->goalIdx : (isSectorField ? m_GoalNodeIdx : -1) };
+			const bool hasLineOfSight{ pLayer ? pLayer->lineOfSight[agentIdx] != 0 : isSectorField && m_pFieldGrid->HasLineOfSight(agentIdx) };
+
+			//With a clear line to the goal there is no need to follow the 8 quantized directions
+			if (m_UseLineOfSight && fieldGoalIdx != -1 && hasLineOfSight)
+			{
+				Vector2 toGoal{ m_pFieldGrid->GetCellWorldPos(fieldGoalIdx) - positions[i] };
+				if (toGoal.Normalize() > 0.f)
+					velocity = toGoal * m_AgentSpeed;
+			}
 
-			if (m_pGridGraph->GetNode(nextNode->GetIndex())->GetCost() < m_NonTraversable)
+			if (velocity == ZeroVector2)
 			{
-				auto itClosed = std::find(closedList.begin(), closedList.end(), nextNode);
-				if (itClosed == closedList.end())
-				{
-					int integrationCost{ (currenctNode->GetIntegrationCost() + int(con->GetCost())) + flowNextNode->GetCost() };
-
-					if (nextNode->GetIntegrationCost() > integrationCost)
-						nextNode->SetIntegrationCost(integrationCost);
-
-					auto itOpen = std::find(openList.begin(), openList.end(), nextNode);
-					if (itOpen == openList.end())
-					{
-						openList.push_back(nextNode);
-					}
-				}
+				velocity = velocities[i];
 			}
+
+			if (m_UseSteering)
+			{
+				velocity += CalculateSteering(i, neighbours) * m_AgentSpeed;
+				if (velocity.MagnitudeSquared() > m_AgentSpeed * m_AgentSpeed)
+					velocity = velocity.GetNormalized() * m_AgentSpeed;
+			}
+
+			if (m_pFieldGrid->GetCost(agentIdx) >= m_NonTraversable)
+			{
+				Vector2 NodePosition{ m_pFieldGrid->GetCellWorldPos(agentIdx) };
+
+				velocity = positions[i] - NodePosition;
+				velocity = velocity.GetNormalized();
+				velocity *= m_AgentSpeed;
+			}
+
+			//Snapping to the direction of a single node needs smoothing, a sampled direction already is smooth
+			orientations[i] = Elite::GetOrientationFromVelocity(velocity);
+			velocities[i] = isSampled ? velocity : Elite::Lerp(velocities[i], velocity, 0.5f);
+
+			if (agentIdx == (groupId == 0 ? m_GoalNodeIdx : m_pGroups->GetGoal(groupId)))
+				pReachedGoals[groupId] = 1;
 		}
-		closedList.push_back(currenctNode);
 	}
 }
 
-void FlowField::CreateAgents(int nrOfAgents)
+const FlowFieldLayer* FlowField::GetGroupLayer(int groupId) const
 {
-	for (int i{}; i < nrOfAgents - 1; i++)
+	if (groupId != 0)
+		return m_pGroups->GetLayer(groupId);
+
+	return m_UseSectors ? nullptr : m_pActiveLayer.get();
+}
+
+void FlowField::SetNrOfGroups(int nrOfGroups)
+{
+	m_NrOfGroups = nrOfGroups;
+	m_pGroups->SetNrOfGroups(nrOfGroups);
+
+	//Group 0 is the main field, the manager only keeps a goal for the others
+	for (int groupId{ 1 }; groupId < nrOfGroups; groupId++)
 	{
-		BaseAgent* pAgent = new BaseAgent();
-		pAgent->SetPosition({ 0.5f, 0.5f });
-		m_Agents.push_back(pAgent);
+		if (m_pGroups->GetGoal(groupId) == -1)
+			m_pGroups->SetGoal(groupId, GetRandomOpenNode());
 	}
 
-	BaseAgent* offsetAgent{ new BaseAgent() };
-	offsetAgent->SetPosition({ 0.6f, 0.6f });
-	m_Agents.push_back(offsetAgent);
+	std::vector<int>& groupIds = m_Crowd.GetGroupIds();
+	for (size_t i{}; i < groupIds.size(); i++)
+		groupIds[i] = int(i) % nrOfGroups;
+
+	UpdateGroupFields();
+}
+
+void FlowField::UpdateGroupFields()
+{
+	if (m_NrOfGroups > 1)
+		m_pGroups->Update(m_IntegrationMode, GetPathCosts(), m_CostVersion, *m_pFieldCache, m_UseThreads ? m_pThreadPool : nullptr);
+}
+
+int FlowField::GetRandomOpenNode() const
+{
+	int randomNr = rand() % (COLUMNS * ROWS);
+	while (m_pFieldGrid->GetCost(randomNr) >= m_NonTraversable)
+	{
+		randomNr = rand() % (COLUMNS * ROWS);
+	}
 
+	return randomNr;
 }
 
-void FlowField::CreateBoundaries()
+Elite::Vector2 FlowField::CalculateSteering(int agentIdx, std::vector<int>& neighbours) const
 {
-	float gridWidth{ COLUMNS * float(m_SizeCell) };
-	float gridHeight{ ROWS * float(m_SizeCell) };
-	float wallSize{float(m_SizeCell)};
+	const Vector2& position = m_Crowd.GetPositions()[agentIdx];
+	m_CrowdHash.QueryNearest(position, NEIGHBOUR_COUNT, m_NeighbourRadius, neighbours, agentIdx);
+	if (neighbours.empty())
+		return ZeroVector2;
+
+	//Separation pushes away harder the closer a neighbour is, cohesion pulls towards their centre
+	Vector2 separation{};
+	Vector2 centre{};
+	for (int neighbourIdx : neighbours)
+	{
+		const Vector2& neighbourPosition = m_Crowd.GetPositions()[neighbourIdx];
+		Vector2 away{ position - neighbourPosition };
+		const float distance{ away.Normalize() };
+		separation += away * (1.f - distance / m_NeighbourRadius);
+		centre += neighbourPosition;
+	}
 
-	Vector2 wallPos{ gridWidth / 2.f, -0.5f * wallSize };
-	m_Walls.push_back(new NavigationColliderElement(wallPos, gridWidth, wallSize));
+	centre /= float(neighbours.size());
+	const Vector2 cohesion{ (centre - position) / m_NeighbourRadius };
 
-	wallPos.y = gridHeight + (0.5f * wallSize);
-	m_Walls.push_back(new NavigationColliderElement(wallPos, gridWidth, wallSize));
+	return separation * m_SeparationWeight + cohesion * m_CohesionWeight;
+}
 
-	wallPos = Vector2{ -0.5f * wallSize, gridHeight / 2.f };
-	m_Walls.push_back(new NavigationColliderElement(wallPos, wallSize, gridHeight));
+void FlowField::UpdateVector(int nodeIdx)
+{
+	m_pFieldGrid->GetDirections()[nodeIdx] = m_pIntegrator->CalculateNeighbourDirection(GetPathCosts(), m_pFieldGrid->GetIntegration(), m_GoalNodeIdx, nodeIdx);
+}
+
+void FlowField::CreateCostField()
+{
+	m_pFieldGrid->SetCost(45, 200);
+}
 
-	wallPos.x = gridWidth + (0.5f * wallSize);
-	m_Walls.push_back(new NavigationColliderElement(wallPos, wallSize, gridHeight));
+void FlowField::CalculateIntegrationField()
+{
+	m_pIntegrator->Integrate(m_IntegrationMode, GetPathCosts(), m_GoalNodeIdx, m_pFieldGrid->GetIntegration());
 }
 
-void FlowField::MakeNotTraversable(int nodeIdx)
+void FlowField::CreateAgents(int nrOfAgents)
 {
-	auto node = m_pGridGraph->GetNode(nodeIdx);
+	//Spread the agents over random open cells, steering can be turned off and then nothing pushes stacked agents apart
+	m_Crowd.Clear();
+	m_Crowd.Reserve(nrOfAgents);
 
-	if (node)
+	for (int i{}; i < nrOfAgents; i++)
 	{
-		node->SetCost(m_NonTraversable);
-		Vector2 nodePos = GetNodePosition(node);
-		m_Walls.push_back(new NavigationColliderElement(nodePos, float(m_SizeCell), float(m_SizeCell)));
+		const float halfSize{ float(m_SizeCell) / 2.f };
+		Vector2 position{ m_pFieldGrid->GetCellWorldPos(GetRandomOpenNode()) };
+		position.x += randomFloat(-halfSize, halfSize);
+		position.y += randomFloat(-halfSize, halfSize);
+		m_Crowd.AddAgent(position, 1.f, i % m_NrOfGroups);
 	}
 }
 
+bool FlowField::MakeNotTraversable(int nodeIdx)
+{
+	//A cell that already is a wall changes no cost, the cached fields stay valid
+	if (nodeIdx < 0 || nodeIdx >= m_pFieldGrid->GetNrOfCells() || !m_pFieldGrid->IsTraversable(nodeIdx))
+		return false;
+
+	m_pFieldGrid->SetCost(nodeIdx, FlowFieldGrid::IMPASSABLE);
+	if (m_UseDensity)
+		m_pDensity->ApplyToCosts(m_pFieldGrid->GetCosts(), m_DensityWeight, m_MinDensity);
+	++m_CostVersion;
+	m_PortalsDirty = true;
+
+	return true;
+}
+
 Vector2 FlowField::GetNodePosition(int nodeIdx) const
 {
-	auto node = m_pGridGraph->GetNode(nodeIdx);
+	return m_pFieldGrid->GetCellWorldPos(nodeIdx);
+}
+
+void FlowField::CalculateVectors()
+{
+	if (m_IntegrationMode == IntegrationMode::Eikonal)
+	{
+		m_pIntegrator->CalculateGradientDirections(m_pIntegrator->GetArrivalTimes(), m_pFieldGrid->GetDirections());
+		return;
+	}
 
-	return GetNodePosition(node);
+	m_pIntegrator->CalculateNeighbourDirections(GetPathCosts(), m_pFieldGrid->GetIntegration(), m_GoalNodeIdx, m_pFieldGrid->GetDirections());
 }
 
-Vector2 FlowField::GetNodePosition(FlowFieldNode* node) const
+float FlowField::BenchmarkVectors(bool useSimd)
 {
-	Vector2 nodePos = m_pGridGraph->GetNodePos(node) * float(m_SizeCell);
-	nodePos.x += float(m_SizeCell) / 2.f;
-	nodePos.y += float(m_SizeCell) / 2.f;
+	//Repeat the kernel on the active layer until enough time passed to measure it. The grid's own integration
+	//is stale after a layer came from the cache or the builder.
+	const bool previousUseSimd{ m_pIntegrator->GetUseSimd() };
+	m_pIntegrator->SetUseSimd(useSimd);
+
+	std::vector<uint16_t> directions{};
+	const auto start = std::chrono::high_resolution_clock::now();
+	double elapsedSeconds{};
+	long long nrOfCells{};
+	while (elapsedSeconds < 0.05)
+	{
+		m_pIntegrator->CalculateNeighbourDirections(GetPathCosts(), m_pActiveLayer->integration, m_pActiveLayer->goalIdx, directions);
+		nrOfCells += m_pFieldGrid->GetNrOfCells();
+		elapsedSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
 
-	return nodePos;
+	m_pIntegrator->SetUseSimd(previousUseSimd);
+	return float(nrOfCells / elapsedSeconds);
 }
 
-void FlowField::CalculateVectors()
+void FlowField::UpdateSimulationImGui()
 {
-	auto nodes = m_pGridGraph->GetAllNodes();
+#ifdef PLATFORM_WINDOWS
+	//A replay only holds the mouse input, so the settings that change the simulation stay as they were
+	//when the recording started. Making agents and groups also draws from rand().
+	if (m_IsRecording || m_IsReplaying)
+	{
+		ImGui::Text(m_IsRecording ? "Recording" : "Replaying");
+		ImGui::Text("%d agents", m_NrOfAgents);
+		ImGui::Text("%d groups", m_NrOfGroups);
+		ImGui::Text(m_UseSectors ? "Hierarchical" : "Flat");
+		ImGui::Text(m_UseDensity ? "Crowd Density" : "No Density");
+		return;
+	}
+
+	ImGui::Checkbox("Bilinear", &m_UseBilinearSampling);
+	ImGui::Checkbox("Line of Sight", &m_UseLineOfSight);
+	ImGui::Checkbox("Steering", &m_UseSteering);
+	ImGui::SliderFloat("Separation", &m_SeparationWeight, 0.f, 4.f);
+	ImGui::SliderFloat("Cohesion", &m_CohesionWeight, 0.f, 1.f);
 
-	for (const auto& node : nodes)
+	ImGui::Spacing();
+	ImGui::Text("Agents");
+	if (ImGui::SliderInt("##Agents", &m_NrOfAgents, 1, 100000))
 	{
-		int idx = node->GetIndex();
-		auto neighbours = m_pIntegrationField->GetConnections(idx);
+		CreateAgents(m_NrOfAgents);
+	}
 
-		int lowestCostNeighbourIdx{};
-		int lowestCost{ INT_MAX };
-		for (const auto& neighbour : neighbours)
+	ImGui::Spacing();
+	ImGui::Text("Groups");
+	if (ImGui::SliderInt("##Groups", &m_NrOfGroups, 1, 32))
+	{
+		SetNrOfGroups(m_NrOfGroups);
+	}
+
+	ImGui::Spacing();
+	ImGui::Text("Integration");
+	if (ImGui::Combo("##Integration", &m_SelectedIntegrationMode, "BFS\0Dijkstra\0Eikonal", 3))
+	{
+		switch (m_SelectedIntegrationMode)
 		{
-			auto neighbourNode = m_pIntegrationField->GetNode(neighbour->GetTo());
-			if (neighbourNode->GetIntegrationCost() < lowestCost)
-			{
-				lowestCost = neighbourNode->GetIntegrationCost();
-				lowestCostNeighbourIdx = neighbourNode->GetIndex();
-			}
+		case 1:
+			m_IntegrationMode = IntegrationMode::Dijkstra;
+			break;
+		case 2:
+			m_IntegrationMode = IntegrationMode::Eikonal;
+			break;
+		case 0:
+		default:
+			m_IntegrationMode = IntegrationMode::BFS;
+			break;
 		}
 
-		auto target = m_pGridGraph->GetNode(lowestCostNeighbourIdx);
-		Vector2 nodePosition{ m_pGridGraph->GetNodePos(node) };
-		Vector2 neighbourPosition{ m_pGridGraph->GetNodePos(target) };
-		
-		Vector2 direction = neighbourPosition - nodePosition;
-		direction = direction.GetNormalized();
-
-		node->SetDirection(direction);
+		CalculateFlowField();
+	}
+	//Also runs the agent update on the thread pool
+	if (ImGui::Checkbox("Multithreaded", &m_UseThreads))
+	{
+		m_pIntegrator->SetThreadPool(m_UseThreads ? m_pThreadPool : nullptr);
+		CalculateFlowField();
+	}
+	//Deterministic runs never build in the background, see CalculateFlowField
+	if (!GetRunSettings().isDeterministic)
+		ImGui::Checkbox("Async Rebuild", &m_UseAsyncRebuild);
+	if (m_UseAsyncRebuild && !GetRunSettings().isDeterministic)
+	{
+		ImGui::Text("%d requests", m_pBuilder->GetNrOfRequests());
+		ImGui::Text("%d builds", m_pBuilder->GetNrOfBuilds());
+	}
+	if (ImGui::Checkbox("Hierarchical", &m_UseSectors))
+	{
+		CalculateFlowField();
+	}
+	if (m_UseSectors)
+	{
+		ImGui::Text("%d portals", m_pSectorMap->GetNrOfPortals());
+		ImGui::Text("%d/%d sectors", m_pSectorMap->GetNrOfBuiltSectors(), m_pSectorMap->GetNrOfSectors());
 	}
-}
 
-void FlowField::ResetField()
-{
-	for (auto& node : m_pIntegrationField->GetAllNodes())
+	if (ImGui::Checkbox("Crowd Density", &m_UseDensity))
+	{
+		if (m_UseDensity)
+		{
+			m_pDensity->Splat(m_Crowd.GetPositions().data(), m_Crowd.GetNrOfAgents());
+			m_pDensity->ApplyToCosts(m_pFieldGrid->GetCosts(), m_DensityWeight, m_MinDensity);
+		}
+		++m_CostVersion;
+		m_PortalsDirty = true;
+		CalculateFlowField();
+	}
+	if (m_UseDensity)
 	{
-		node->SetIntegrationCost(69420360); //Very carefully calculated number
+		ImGui::SliderFloat("Density Weight", &m_DensityWeight, 0.f, 20.f);
+		ImGui::SliderFloat("Min Density", &m_MinDensity, 0.f, 10.f);
+		ImGui::SliderInt("Density Frames", &m_DensityInterval, 1, 60);
 	}
+#endif
 }
 
 void FlowField::UpdateImGui()
@@ -435,7 +870,7 @@ void FlowField::UpdateImGui()
 		ImGui::Text("CONTROLS");
 		ImGui::Indent();
 		ImGui::Text("LMB: target");
-		ImGui::Text("RMB: start");
+		ImGui::Text("MMB: wall");
 		ImGui::Unindent();
 
 		/*Spacing*/ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing(); ImGui::Spacing();
@@ -444,30 +879,21 @@ void FlowField::UpdateImGui()
 		ImGui::Indent();
 		ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 		ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+		ImGui::Text("%d B fields", int(m_pFieldGrid->GetMemorySize()));
+		ImGui::Text("%.2f ms agents", m_AgentUpdateMs);
+		if (ImGui::Button("Bench Vectors"))
+		{
+			m_ScalarCellsPerSecond = BenchmarkVectors(false);
+			m_SimdCellsPerSecond = FlowFieldIntegrator::IsSimdSupported() ? BenchmarkVectors(true) : 0.f;
+		}
+		ImGui::Text("Scalar %.1f Mc/s", m_ScalarCellsPerSecond / 1e6f);
+		ImGui::Text("SIMD %.1f Mc/s", m_SimdCellsPerSecond / 1e6f);
 		ImGui::Unindent();
 
 		/*Spacing*/ImGui::Spacing(); ImGui::Separator(); ImGui::Spacing(); ImGui::Spacing();
 
-		ImGui::Text("A* Pathfinding");
-		ImGui::Spacing();
-
-		ImGui::Text("Middle Mouse");
-		ImGui::Text("controls");
-		std::string buttonText{ "" };
-		if (m_StartSelected)
-			buttonText += "Start Node";
-		else
-			buttonText += "End Node";
-
-		if (ImGui::Button(buttonText.c_str()))
-		{
-			m_StartSelected = !m_StartSelected;
-		}
-
 		ImGui::Checkbox("Grid", &m_bDrawGrid);
 		ImGui::Checkbox("NodeNumbers", &m_bDrawNodeNumbers);
-		ImGui::Checkbox("Connections", &m_bDrawConnections);
-		ImGui::Checkbox("Connections Costs", &m_bDrawConnectionsCosts);
 		ImGui::Spacing();
 		ImGui::Spacing();
 		ImGui::Text("Integration Field");
@@ -475,31 +901,19 @@ void FlowField::UpdateImGui()
 		ImGui::Checkbox("Draw Costs", &m_DrawCosts);
 		ImGui::Checkbox("Draw Vectors", &m_DrawVectors);
 		ImGui::Checkbox("Draw Goal", &m_DrawGoal);
+		ImGui::Checkbox("Draw Line of Sight", &m_DrawLineOfSight);
+		ImGui::Checkbox("Draw Agents", &m_DrawAgents);
+		UpdateSimulationImGui();
 
-		if (ImGui::Combo("", &m_SelectedHeuristic, "Manhattan\0Euclidean\0SqrtEuclidean\0Octile\0Chebyshev", 4))
+		ImGui::Spacing();
+		ImGui::Text("Field Cache (KB)");
+		if (ImGui::SliderInt("##CacheBudget", &m_CacheBudgetKB, 0, 4096))
 		{
-			switch (m_SelectedHeuristic)
-			{
-			case 0:
-				m_pHeuristicFunction = HeuristicFunctions::Manhattan;
-				break;
-			case 1:
-				m_pHeuristicFunction = HeuristicFunctions::Euclidean;
-				break;
-			case 2:
-				m_pHeuristicFunction = HeuristicFunctions::SqrtEuclidean;
-				break;
-			case 3:
-				m_pHeuristicFunction = HeuristicFunctions::Octile;
-				break;
-			case 4:
-				m_pHeuristicFunction = HeuristicFunctions::Chebyshev;
-				break;
-			default:
-				m_pHeuristicFunction = HeuristicFunctions::Chebyshev;
-				break;
-			}
+			m_pFieldCache->SetMemoryBudget(size_t(m_CacheBudgetKB) * 1024);
 		}
+		ImGui::Text("%d fields", m_pFieldCache->GetNrOfEntries());
+		ImGui::Text("%d hits", m_pFieldCache->GetNrOfHits());
+		ImGui::Text("%d misses", m_pFieldCache->GetNrOfMisses());
 		ImGui::Spacing();
 
 		//End
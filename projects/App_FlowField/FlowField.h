@@ -9,12 +9,19 @@
 // Includes & Forward Declarations
 //-----------------------------------------------------------------
 #include "framework/EliteInterfaces/EIApp.h"
-#include "framework\EliteAI\EliteGraphs\EGridGraph.h"
-#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphEditor.h"
-#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
-
-#include "projects/Shared/BaseAgent.h"
-#include "projects/Shared/NavigationColliderElement.h"
+#include "framework\EliteAI\EliteGraphs\EGraphEnums.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphVisuals.h"
+
+#include "FlowFieldGrid.h"
+#include "FlowFieldIntegrator.h"
+#include "FlowFieldSectorMap.h"
+#include "FlowFieldCache.h"
+#include "FlowFieldBuilder.h"
+#include "FlowFieldDensity.h"
+#include "FlowFieldGroups.h"
+#include "FlowFieldReplay.h"
+#include "CrowdStore.h"
+#include "CrowdSpatialHash.h"
 //-----------------------------------------------------------------
 // Application
 //-----------------------------------------------------------------
@@ -42,52 +49,131 @@ private:
 	static const int COLUMNS = 10;
 	static const int ROWS = 10;
 	unsigned int m_SizeCell = 15;
-	Elite::GridGraph<Elite::FlowFieldNode, Elite::GraphConnection>* m_pGridGraph;
-	Elite::GridGraph<Elite::IntegrationFieldNode, Elite::GraphConnection>* m_pIntegrationField;
-
+	FlowFieldGrid* m_pFieldGrid = nullptr;
+
+	//Integration datamembers
+	FlowFieldIntegrator* m_pIntegrator = nullptr;
+	Elite::EThreadPool* m_pThreadPool = nullptr;
+	bool m_UseThreads = false;
+	IntegrationMode m_IntegrationMode = IntegrationMode::BFS;
+	int m_SelectedIntegrationMode = 0;
+	std::vector<int> m_ChangedCells;
+
+	//Direction kernel benchmark, in cells per second
+	float m_ScalarCellsPerSecond = 0.f;
+	float m_SimdCellsPerSecond = 0.f;
+
+	//Cache datamembers, the active layer is what agents follow
+	FlowFieldCache* m_pFieldCache = nullptr;
+	std::shared_ptr<const FlowFieldLayer> m_pActiveLayer = nullptr;
+	unsigned int m_CostVersion = 0;
+	bool m_IsActiveLayerInGraph = false;
+	int m_CacheBudgetKB = 256;
+
+	//Background rebuilds, agents keep the active layer until the requested one is done
+	FlowFieldBuilder* m_pBuilder = nullptr;
+	bool m_UseAsyncRebuild = false;
+	bool m_IsRebuildPending = false;
+	FlowFieldKey m_RequestedKey{ invalid_node_index, 0, 0 };
+
+	//Hierarchical datamembers
+	static const int SECTOR_SIZE = 5;
+	FlowFieldSectorMap* m_pSectorMap = nullptr;
+	bool m_UseSectors = false;
+	bool m_PortalsDirty = true;
+
+	//Group datamembers, group 0 follows the field above and every other group has its own goal
+	FlowFieldGroups* m_pGroups = nullptr;
+	int m_NrOfGroups = 1;
+
+	//Record/replay of deterministic runs, frames count calls to Update
+	FlowFieldReplay m_Replay{};
+	int m_FrameNr = 0;
+	bool m_IsRecording = false;
+	bool m_IsReplaying = false;
+
+	//Crowd density datamembers, crowded cells cost more so agents spread over other routes
+	FlowFieldDensity* m_pDensity = nullptr;
+	bool m_UseDensity = false;
+	float m_DensityWeight = 2.f;
+	float m_MinDensity = 1.f;
+	int m_DensityInterval = 10;
+	int m_FramesSinceDensity = 0;
 
-	//Editor and Visualisation
-	Elite::EGraphEditor m_GraphEditor{};
-	Elite::EGraphRenderer m_GraphRenderer{};
 
 	//Debug rendering information
 	bool m_bDrawGrid = true;
 	bool m_bDrawNodeNumbers = false;
-	bool m_bDrawConnections = false;
-	bool m_bDrawConnectionsCosts = false;
-	bool m_StartSelected = true;
-	int m_SelectedHeuristic = 4;
-	Elite::Heuristic m_pHeuristicFunction = Elite::HeuristicFunctions::Chebyshev;
 
 	bool m_DrawIntegrationCosts = false;
 	bool m_DrawCosts = false;
 	bool m_DrawVectors = true;
 	bool m_DrawGoal = true;
+	bool m_DrawLineOfSight = false;
 
 	float m_AgentSpeed = 10.f;
 
-	const int m_NonTraversable = 100000;
-	std::vector<BaseAgent*> m_Agents;
-	std::vector<NavigationColliderElement*> m_Walls;
+	const int m_NonTraversable = FlowFieldGrid::IMPASSABLE;
+	CrowdStore m_Crowd{};
+	std::vector<Elite::Vector2> m_AgentDirections;
+
+	//Agents are updated in chunks, per chunk side effects are gathered and applied after the parallel part.
+	//Reached goals are flagged per chunk and per group.
+	static const int AGENT_CHUNK_SIZE = 1024;
+	std::vector<char> m_ChunkReachedGoal;
+	std::vector<std::vector<int>> m_ChunkSectors;
+	float m_AgentUpdateMs = 0.f;
+	bool m_UseBilinearSampling = true;
+	bool m_UseLineOfSight = true;
+
+	//Separation and cohesion with the nearest agents, added on top of the flow direction
+	static const int NEIGHBOUR_COUNT = 6;
+	float m_NeighbourRadius = 5.f;
+	CrowdSpatialHash m_CrowdHash{ m_NeighbourRadius };
+	bool m_UseSteering = true;
+	float m_SeparationWeight = 1.f;
+	float m_CohesionWeight = 0.2f;
+
+	int m_NrOfAgents = 50;
+	bool m_DrawAgents = true;
 
 	//Functions
-	void MakeGridGraph();
+	void MakeFieldGrid();
+	void HandleInput();
+	void StartRecordOrReplay();
+	void ApplyReplayInput();
+	void RecordEvent(ReplayEventType type, int groupId, int nodeIdx);
+	void SetGoal(int nodeIdx);
+	void PlaceWall(int nodeIdx);
 	void CalculateFlowField();
+	void RepairFlowField(int nodeIdx, int oldCost);
+	void CalculateSectorFlowField();
+	void StoreActiveLayer();
+	void PollAsyncRebuild();
+	const std::vector<uint8_t>& GetPathCosts() const;
+	const std::vector<uint8_t>& GetLineOfSight() const;
+	void CalculateLineOfSight();
+	void UpdateDensityCosts();
 	void CreateCostField();
 	void CalculateIntegrationField();
-	void Dijkstra();
-	void BFS();
 
 	void CreateAgents(int nrOfAgents);
-	void CreateBoundaries();
+	void UpdateAgents(float deltaTime);
+	void UpdateAgentRange(int firstAgent, int endAgent, char* pReachedGoals);
+	const FlowFieldLayer* GetGroupLayer(int groupId) const;
+	void SetNrOfGroups(int nrOfGroups);
+	void UpdateGroupFields();
+	int GetRandomOpenNode() const;
+	Elite::Vector2 CalculateSteering(int agentIdx, std::vector<int>& neighbours) const;
 
-	void MakeNotTraversable(int nodeIdx);
-	Vector2 GetNodePosition(int nodeIdx) const;
-	Vector2 GetNodePosition(FlowFieldNode* node) const;
+	bool MakeNotTraversable(int nodeIdx);
+	Elite::Vector2 GetNodePosition(int nodeIdx) const;
 
 	void CalculateVectors();
-	void ResetField();
+	void UpdateVector(int nodeIdx);
+	float BenchmarkVectors(bool useSimd);
 	void UpdateImGui();
+	void UpdateSimulationImGui();
 
 	//C++ make the class non-copyable
 	FlowField(const FlowField&) = delete;
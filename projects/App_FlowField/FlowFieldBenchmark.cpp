@@ -0,0 +1,314 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//-----------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------
+#include "FlowFieldGrid.h"
+#include "FlowFieldIntegrator.h"
+#include "CrowdStore.h"
+#include "CrowdSpatialHash.h"
+
+//-----------------------------------------------------------------
+// Flow Field Benchmark
+//-----------------------------------------------------------------
+// Standalone executable (FlowFieldBenchmark.vcxproj) that times the flow field engine without window or renderer.
+// Every result is one CSV line on stdout, progress goes to stderr, so runs can be piped to a file and compared.
+
+//Referenced by the framework, nothing here shuts down early
+bool gRequestShutdown = false;
+
+namespace
+{
+	struct BenchmarkSettings
+	{
+		int maxGridSize = 4096;
+		int maxNrOfAgents = 100000;
+		double minSeconds = 0.25;	//Every benchmark repeats until this much time passed
+		int maxIterations = 1000;
+		unsigned int nrOfThreads = 0;	//0 uses every hardware thread
+		unsigned int seed = 1;
+	};
+
+	struct BenchmarkResult
+	{
+		std::string name;
+		int columns;
+		int rows;
+		int nrOfAgents;
+		int iterations;
+		double meanMs;
+		double minMs;
+		double itemsPerSecond;	//Cells, edits or agents per second, depending on the benchmark
+	};
+
+	const int COST_STRAIGHT = 1;
+	const int COST_DIAGONAL = 2;
+	const float CELL_SIZE = 15.f;
+	const float AGENT_SPEED = 10.f;
+	const float TIME_STEP = 1.f / 60.f;
+	const int AGENT_CHUNK_SIZE = 1024;
+	const int AGENT_FRAMES = 60;	//Benchmarks that move the crowd always simulate this many frames
+
+	void PrintHeader()
+	{
+		std::cout << "benchmark,columns,rows,agents,iterations,mean_ms,min_ms,items_per_second" << std::endl;
+	}
+
+	void PrintResult(const BenchmarkResult& result)
+	{
+		std::cout << result.name << ',' << result.columns << ',' << result.rows << ',' << result.nrOfAgents << ','
+			<< result.iterations << ',' << result.meanMs << ',' << result.minMs << ',' << result.itemsPerSecond << std::endl;
+		std::cerr << "  " << result.name << " " << result.columns << "x" << result.rows;
+		if (result.nrOfAgents > 0)
+			std::cerr << " " << result.nrOfAgents << " agents";
+		std::cerr << ": " << result.meanMs << " ms" << std::endl;
+	}
+
+	//Runs the function until the minimum time passed (at least once), the items count what one call processes.
+	//Functions that change their own state pass a fixed number of iterations, so every run does the same work.
+	template<typename Function>
+	void Measure(const BenchmarkSettings& settings, const std::string& name, int columns, int rows, int nrOfAgents, long long nrOfItems, Function function, int nrOfIterations = 0)
+	{
+		double totalSeconds{};
+		double minSeconds{ DBL_MAX };
+		int iterations{};
+		auto isDone = [&]()
+		{
+			if (nrOfIterations > 0)
+				return iterations >= nrOfIterations;
+			return iterations >= settings.maxIterations || (iterations > 0 && totalSeconds >= settings.minSeconds);
+		};
+
+		while (!isDone())
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+			function();
+			const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+			totalSeconds += seconds;
+			minSeconds = std::min(minSeconds, seconds);
+			++iterations;
+		}
+
+		const double meanSeconds{ totalSeconds / iterations };
+		PrintResult({ name, columns, rows, nrOfAgents, iterations, meanSeconds * 1000.0, minSeconds * 1000.0, double(nrOfItems) / meanSeconds });
+	}
+
+	//Scattered walls on a fixed seed, the goal corner stays open. The same settings always give the same map.
+	std::vector<uint8_t> MakeCosts(int columns, int rows, unsigned int seed)
+	{
+		std::mt19937 generator{ seed };
+		std::uniform_int_distribution<int> percentage{ 0, 99 };
+
+		std::vector<uint8_t> costs(size_t(columns) * rows, 1);
+		for (uint8_t& cost : costs)
+		{
+			const int roll{ percentage(generator) };
+			if (roll < 15)
+				cost = FlowFieldGrid::IMPASSABLE;
+			else if (roll < 25)
+				cost = 4;
+		}
+		costs[0] = 1;
+		return costs;
+	}
+
+	void BenchmarkGrid(const BenchmarkSettings& settings, int size, Elite::EThreadPool& threadPool)
+	{
+		const int columns{ size };
+		const int rows{ size };
+		const long long nrOfCells{ static_cast<long long>(columns) * rows };
+		const int goalIdx{ 0 };
+		std::cerr << "Grid " << columns << "x" << rows << std::endl;
+
+		std::vector<uint8_t> costs{ MakeCosts(columns, rows, settings.seed) };
+		FlowFieldIntegrator integrator{ columns, rows, true, COST_STRAIGHT, COST_DIAGONAL, FlowFieldGrid::IMPASSABLE };
+		std::vector<int> integration{};
+		std::vector<uint16_t> directions{};
+
+		//Integration
+		Measure(settings, "integrate_bfs", columns, rows, 0, nrOfCells, [&]() { integrator.IntegrateBFS(costs, goalIdx, integration); });
+		Measure(settings, "integrate_dijkstra", columns, rows, 0, nrOfCells, [&]() { integrator.IntegrateDijkstra(costs, goalIdx, integration); });
+		Measure(settings, "integrate_dijkstra_parallel", columns, rows, 0, nrOfCells, [&]() { integrator.IntegrateDijkstraParallel(costs, goalIdx, integration, threadPool); });
+
+		std::vector<float> arrivalTimes{};
+		Measure(settings, "integrate_eikonal", columns, rows, 0, nrOfCells, [&]() { integrator.IntegrateEikonal(costs, goalIdx, arrivalTimes); });
+		Measure(settings, "directions_gradient", columns, rows, 0, nrOfCells, [&]() { integrator.CalculateGradientDirections(arrivalTimes, directions); });
+
+		//Vector generation, on the Dijkstra field every later benchmark uses
+		integrator.IntegrateDijkstra(costs, goalIdx, integration);
+		integrator.SetUseSimd(false);
+		Measure(settings, "directions_scalar", columns, rows, 0, nrOfCells, [&]() { integrator.CalculateNeighbourDirections(costs, integration, goalIdx, directions); });
+		if (FlowFieldIntegrator::IsSimdSupported())
+		{
+			integrator.SetUseSimd(true);
+			Measure(settings, "directions_simd", columns, rows, 0, nrOfCells, [&]() { integrator.CalculateNeighbourDirections(costs, integration, goalIdx, directions); });
+		}
+
+		std::vector<uint8_t> lineOfSight{};
+		Measure(settings, "line_of_sight", columns, rows, 0, nrOfCells, [&]() { integrator.CalculateLineOfSight(costs, goalIdx, lineOfSight); });
+
+		//Cost edits, every iteration places a wall on an open cell and removes it again, repairing the field both times.
+		//Repairs like FlowField::RepairFlowField, a failed repair integrates and recalculates every direction.
+		{
+			std::mt19937 generator{ settings.seed };
+			std::uniform_int_distribution<int> cellDistribution{ 1, int(nrOfCells) - 1 };
+			std::vector<int> changedCells{};
+
+			auto repair = [&](int idx, int oldCost)
+			{
+				if (!integrator.RepairDijkstra(costs, goalIdx, idx, oldCost, integration, changedCells))
+				{
+					integrator.IntegrateDijkstra(costs, goalIdx, integration);
+					integrator.CalculateNeighbourDirections(costs, integration, goalIdx, directions);
+					return;
+				}
+
+				//Directions change for the repaired cells and the cells that look at them
+				changedCells.push_back(idx);
+				for (int changedIdx : changedCells)
+				{
+					const int col{ changedIdx % columns };
+					const int row{ changedIdx / columns };
+
+					for (int neighbourRow{ std::max(row - 1, 0) }; neighbourRow <= std::min(row + 1, rows - 1); ++neighbourRow)
+					{
+						for (int neighbourCol{ std::max(col - 1, 0) }; neighbourCol <= std::min(col + 1, columns - 1); ++neighbourCol)
+						{
+							const int neighbourIdx{ neighbourRow * columns + neighbourCol };
+							directions[neighbourIdx] = integrator.CalculateNeighbourDirection(costs, integration, goalIdx, neighbourIdx);
+						}
+					}
+				}
+			};
+
+			integrator.CalculateNeighbourDirections(costs, integration, goalIdx, directions);
+			Measure(settings, "cost_edit_repair", columns, rows, 0, 2, [&]()
+			{
+				int idx{ cellDistribution(generator) };
+				while (costs[idx] == FlowFieldGrid::IMPASSABLE)
+					idx = cellDistribution(generator);
+
+				const uint8_t oldCost{ costs[idx] };
+				costs[idx] = FlowFieldGrid::IMPASSABLE;
+				repair(idx, oldCost);
+				costs[idx] = oldCost;
+				repair(idx, FlowFieldGrid::IMPASSABLE);
+			});
+		}
+
+		//Agents, moved along the field the same way the app does: sample, scale to speed and integrate
+		FlowFieldGrid grid{ columns, rows, CELL_SIZE };
+		for (int i{}; i < grid.GetNrOfCells(); ++i)
+			grid.SetCost(i, costs[i]);
+		integrator.CalculateNeighbourDirections(costs, integration, goalIdx, grid.GetDirections());
+
+		std::vector<int> openCells{};
+		for (int i{}; i < grid.GetNrOfCells(); ++i)
+		{
+			if (grid.IsTraversable(i))
+				openCells.push_back(i);
+		}
+
+		for (int nrOfAgents{ 1000 }; nrOfAgents <= settings.maxNrOfAgents; nrOfAgents *= 10)
+		{
+			//Every agent benchmark starts from the same crowd, whatever ran before it
+			CrowdStore crowd{};
+			crowd.Reserve(nrOfAgents);
+			auto resetCrowd = [&]()
+			{
+				std::mt19937 generator{ settings.seed };
+				std::uniform_int_distribution<int> openDistribution{ 0, int(openCells.size()) - 1 };
+
+				crowd.Clear();
+				for (int i{}; i < nrOfAgents; ++i)
+					crowd.AddAgent(grid.GetCellWorldPos(openCells[openDistribution(generator)]));
+			};
+
+			std::vector<Elite::Vector2> agentDirections(nrOfAgents);
+			auto updateRange = [&](int firstAgent, int endAgent)
+			{
+				grid.SampleDirections(grid.GetDirections(), crowd.GetPositions().data() + firstAgent, agentDirections.data() + firstAgent, endAgent - firstAgent);
+				std::vector<Elite::Vector2>& velocities = crowd.GetVelocities();
+				for (int i{ firstAgent }; i < endAgent; ++i)
+					velocities[i] = agentDirections[i] * AGENT_SPEED;
+				crowd.Integrate(TIME_STEP, grid, firstAgent, endAgent);
+			};
+
+			//Agents walk on between iterations, like frames in the app, for a fixed number of frames
+			resetCrowd();
+			Measure(settings, "agents_update", columns, rows, nrOfAgents, nrOfAgents, [&]() { updateRange(0, nrOfAgents); }, AGENT_FRAMES);
+
+			const int nrOfChunks{ (nrOfAgents + AGENT_CHUNK_SIZE - 1) / AGENT_CHUNK_SIZE };
+			resetCrowd();
+			Measure(settings, "agents_update_parallel", columns, rows, nrOfAgents, nrOfAgents, [&]()
+			{
+				threadPool.ParallelFor(nrOfChunks, [&](int chunk)
+				{
+					const int firstAgent{ chunk * AGENT_CHUNK_SIZE };
+					updateRange(firstAgent, std::min(firstAgent + AGENT_CHUNK_SIZE, nrOfAgents));
+				});
+			}, AGENT_FRAMES);
+
+			CrowdSpatialHash hash{ 5.f };
+			std::vector<int> neighbours{};
+			resetCrowd();
+			Measure(settings, "agents_neighbours", columns, rows, nrOfAgents, nrOfAgents, [&]()
+			{
+				hash.Build(crowd.GetPositions().data(), nrOfAgents);
+				for (int i{}; i < nrOfAgents; ++i)
+					hash.QueryNearest(crowd.GetPositions()[i], 6, 5.f, neighbours, i);
+			});
+		}
+	}
+
+	//Returns false on arguments it doesn't know
+	bool ParseSettings(int argc, char* argv[], BenchmarkSettings& settings)
+	{
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const string argument{ argv[i] };
+			const bool hasValue{ i + 1 < argc };
+
+			if (argument == "--max-size" && hasValue)
+				settings.maxGridSize = stoi(string(argv[++i]));
+			else if (argument == "--max-agents" && hasValue)
+				settings.maxNrOfAgents = stoi(string(argv[++i]));
+			else if (argument == "--min-time" && hasValue)
+				settings.minSeconds = stod(string(argv[++i]));
+			else if (argument == "--threads" && hasValue)
+				settings.nrOfThreads = static_cast<unsigned int>(stoul(string(argv[++i])));
+			else if (argument == "--seed" && hasValue)
+				settings.seed = static_cast<unsigned int>(stoul(string(argv[++i])));
+			else
+				return false;
+		}
+		return true;
+	}
+}
+
+//Main
+#undef main //Undefine SDL_main as main
+int main(int argc, char* argv[])
+{
+	BenchmarkSettings settings{};
+	if (!ParseSettings(argc, argv, settings))
+	{
+		std::cerr << "Usage: [--max-size <cells>] [--max-agents <count>] [--min-time <seconds>] [--threads <count>] [--seed <seed>]" << std::endl;
+		return 1;
+	}
+
+	Elite::EThreadPool threadPool{ settings.nrOfThreads };
+	std::cerr << "Flow field benchmark, " << threadPool.GetNrOfThreads() << " threads" << std::endl;
+
+	PrintHeader();
+	const int gridSizes[]{ 10, 64, 256, 1024, 4096 };
+	for (int size : gridSizes)
+	{
+		if (size <= settings.maxGridSize)
+			BenchmarkGrid(settings, size, threadPool);
+	}
+
+	return 0;
+}
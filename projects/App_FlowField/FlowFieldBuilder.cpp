@@ -0,0 +1,119 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include "FlowFieldBuilder.h"
+
+//Constructor & Destructor
+FlowFieldBuilder::FlowFieldBuilder(int columns, int rows, bool isConnectedDiagonally, int costStraight, int costDiagonal, int nonTraversable, unsigned int nrOfThreads)
+	: m_Integrator(columns, rows, isConnectedDiagonally, costStraight, costDiagonal, nonTraversable)
+	, m_ThreadPool(std::max(1u, nrOfThreads))
+{
+	//Started last, everything the worker uses exists by now
+	m_Worker = std::thread(&FlowFieldBuilder::WorkerLoop, this);
+}
+
+FlowFieldBuilder::~FlowFieldBuilder()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_IsStopping = true;
+	}
+	m_RequestAvailable.notify_one();
+
+	m_Worker.join();
+}
+
+//Functions
+void FlowFieldBuilder::Request(const FlowFieldKey& key, IntegrationMode mode, const std::vector<uint8_t>& costs, bool useThreads)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_PendingRequest.key = key;
+		m_PendingRequest.mode = mode;
+		m_PendingRequest.costs = costs;
+		m_PendingRequest.useThreads = useThreads;
+		m_HasPendingRequest = true;
+		++m_NrOfRequests;
+	}
+	m_RequestAvailable.notify_one();
+}
+
+bool FlowFieldBuilder::TakeResult(FlowFieldKey& key, std::shared_ptr<const FlowFieldLayer>& pLayer)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (!m_pResult)
+		return false;
+
+	key = m_ResultKey;
+	pLayer = std::move(m_pResult);
+	m_pResult = nullptr;
+	return true;
+}
+
+bool FlowFieldBuilder::IsBusy() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_IsBuilding || m_HasPendingRequest;
+}
+
+int FlowFieldBuilder::GetNrOfRequests() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_NrOfRequests;
+}
+
+int FlowFieldBuilder::GetNrOfBuilds() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_NrOfBuilds;
+}
+
+void FlowFieldBuilder::WorkerLoop()
+{
+	BuildRequest request{};
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_IsBuilding = false;
+			m_RequestAvailable.wait(lock, [this]() { return m_IsStopping || m_HasPendingRequest; });
+			if (m_IsStopping)
+				return;
+
+			//Swapping keeps both cost buffers allocated
+			std::swap(request, m_PendingRequest);
+			m_HasPendingRequest = false;
+			m_IsBuilding = true;
+		}
+
+		auto pLayer = Build(request);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_ResultKey = request.key;
+		m_pResult = std::move(pLayer);
+		++m_NrOfBuilds;
+	}
+}
+
+std::shared_ptr<const FlowFieldLayer> FlowFieldBuilder::Build(const BuildRequest& request)
+{
+	m_Integrator.SetThreadPool(request.useThreads ? &m_ThreadPool : nullptr);
+	return BuildLayer(m_Integrator, request.mode, request.costs, request.key.goalIdx);
+}
+
+std::shared_ptr<FlowFieldLayer> FlowFieldBuilder::BuildLayer(FlowFieldIntegrator& integrator, IntegrationMode mode, const std::vector<uint8_t>& costs, int goalIdx)
+{
+	auto pLayer = std::make_shared<FlowFieldLayer>();
+	pLayer->goalIdx = goalIdx;
+
+	integrator.Integrate(mode, costs, goalIdx, pLayer->integration);
+
+	if (mode == IntegrationMode::Eikonal)
+		integrator.CalculateGradientDirections(integrator.GetArrivalTimes(), pLayer->directions);
+	else
+		integrator.CalculateNeighbourDirections(costs, pLayer->integration, goalIdx, pLayer->directions);
+
+	integrator.CalculateLineOfSight(costs, goalIdx, pLayer->lineOfSight);
+	return pLayer;
+}
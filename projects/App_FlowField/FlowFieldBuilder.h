@@ -0,0 +1,76 @@
+#ifndef FLOWFIELD_BUILDER_H
+#define FLOWFIELD_BUILDER_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "FlowFieldIntegrator.h"
+#include "FlowFieldCache.h"
+
+//-----------------------------------------------------------------
+// Background Builder
+//-----------------------------------------------------------------
+// Builds flow field layers on a worker thread while agents keep following the current one.
+// Only the newest request is kept, requests made while a build is running coalesce into one.
+// The builder has its own thread pool, a parallel build never holds up a ParallelFor of the main thread.
+class FlowFieldBuilder final
+{
+public:
+	//Constructor & Destructor
+	FlowFieldBuilder(int columns, int rows, bool isConnectedDiagonally, int costStraight, int costDiagonal, int nonTraversable, unsigned int nrOfThreads);
+	~FlowFieldBuilder();
+
+	//Queues a build on a copy of the costs, replaces a request that didn't start yet
+	void Request(const FlowFieldKey& key, IntegrationMode mode, const std::vector<uint8_t>& costs, bool useThreads);
+
+	//Hands over the last finished layer, returns false when nothing finished since the last call
+	bool TakeResult(FlowFieldKey& key, std::shared_ptr<const FlowFieldLayer>& pLayer);
+
+	//Integration, directions and line of sight of one goal, shared with every other place that builds layers
+	static std::shared_ptr<FlowFieldLayer> BuildLayer(FlowFieldIntegrator& integrator, IntegrationMode mode, const std::vector<uint8_t>& costs, int goalIdx);
+
+	bool IsBusy() const;
+	int GetNrOfRequests() const;
+	int GetNrOfBuilds() const;
+
+private:
+	struct BuildRequest
+	{
+		FlowFieldKey key;
+		IntegrationMode mode;
+		std::vector<uint8_t> costs;
+		bool useThreads;
+	};
+
+	//Datamembers
+	//Only touched by the worker
+	FlowFieldIntegrator m_Integrator;
+	Elite::EThreadPool m_ThreadPool;
+
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_RequestAvailable;
+	BuildRequest m_PendingRequest{};
+	bool m_HasPendingRequest = false;
+	bool m_IsBuilding = false;
+	bool m_IsStopping = false;
+
+	FlowFieldKey m_ResultKey{};
+	std::shared_ptr<const FlowFieldLayer> m_pResult = nullptr;
+
+	int m_NrOfRequests = 0;
+	int m_NrOfBuilds = 0;
+
+	std::thread m_Worker;
+
+	//Functions
+	void WorkerLoop();
+	std::shared_ptr<const FlowFieldLayer> Build(const BuildRequest& request);
+
+	//C++ make the class non-copyable
+	FlowFieldBuilder(const FlowFieldBuilder&) = delete;
+	FlowFieldBuilder& operator=(const FlowFieldBuilder&) = delete;
+};
+#endif
@@ -0,0 +1,72 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include "FlowFieldCache.h"
+
+//Constructor
+FlowFieldCache::FlowFieldCache(size_t memoryBudget)
+	: m_MemoryBudget(memoryBudget)
+{
+}
+
+//Functions
+std::shared_ptr<const FlowFieldLayer> FlowFieldCache::Find(const FlowFieldKey& key)
+{
+	auto lookupIt = m_Lookup.find(key);
+	if (lookupIt == m_Lookup.end())
+	{
+		++m_NrOfMisses;
+		return nullptr;
+	}
+
+	++m_NrOfHits;
+	m_Entries.splice(m_Entries.begin(), m_Entries, lookupIt->second);
+	return lookupIt->second->pLayer;
+}
+
+void FlowFieldCache::Insert(const FlowFieldKey& key, const std::shared_ptr<const FlowFieldLayer>& pLayer)
+{
+	auto lookupIt = m_Lookup.find(key);
+	if (lookupIt != m_Lookup.end())
+		Erase(lookupIt->second);
+
+	if (!pLayer)
+		return;
+
+	const size_t memorySize = pLayer->GetMemorySize();
+	if (memorySize > m_MemoryBudget)
+		return;
+
+	m_Entries.push_front({ key, pLayer, memorySize });
+	m_Lookup[key] = m_Entries.begin();
+	m_MemoryUsed += memorySize;
+
+	EvictToBudget();
+}
+
+void FlowFieldCache::Clear()
+{
+	m_Entries.clear();
+	m_Lookup.clear();
+	m_MemoryUsed = 0;
+}
+
+void FlowFieldCache::SetMemoryBudget(size_t memoryBudget)
+{
+	m_MemoryBudget = memoryBudget;
+	EvictToBudget();
+}
+
+void FlowFieldCache::Erase(std::list<Entry>::iterator it)
+{
+	m_MemoryUsed -= it->memorySize;
+	m_Lookup.erase(it->key);
+	m_Entries.erase(it);
+}
+
+void FlowFieldCache::EvictToBudget()
+{
+	while (m_MemoryUsed > m_MemoryBudget && !m_Entries.empty())
+		Erase(std::prev(m_Entries.end()));
+}
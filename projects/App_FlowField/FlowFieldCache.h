@@ -0,0 +1,107 @@
+#ifndef FLOWFIELD_CACHE_H
+#define FLOWFIELD_CACHE_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+//-----------------------------------------------------------------
+// Cached Field
+//-----------------------------------------------------------------
+// Everything an agent needs to follow the field towards one goal.
+// Layers are shared and never changed once they are in the cache.
+struct FlowFieldLayer
+{
+	std::vector<int> integration;
+	std::vector<uint16_t> directions;	//Packed, see FlowFieldGrid::PackDirection
+	std::vector<uint8_t> lineOfSight;
+	int goalIdx = -1;
+
+	size_t GetMemorySize() const
+	{
+		return sizeof(FlowFieldLayer) + integration.capacity() * sizeof(int) + directions.capacity() * sizeof(uint16_t)
+			+ lineOfSight.capacity() * sizeof(uint8_t);
+	}
+};
+
+struct FlowFieldKey
+{
+	int goalIdx;
+	unsigned int costVersion;	//Bumped every time the cost field changes, older layers never match again
+	int integrationMode;
+
+	bool operator==(const FlowFieldKey& other) const
+	{
+		return goalIdx == other.goalIdx && costVersion == other.costVersion && integrationMode == other.integrationMode;
+	}
+};
+
+struct FlowFieldKeyHash
+{
+	size_t operator()(const FlowFieldKey& key) const
+	{
+		size_t hash = std::hash<int>()(key.goalIdx);
+		hash ^= std::hash<unsigned int>()(key.costVersion) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= std::hash<int>()(key.integrationMode) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		return hash;
+	}
+};
+
+//-----------------------------------------------------------------
+// Cache
+//-----------------------------------------------------------------
+// Least recently used cache of flow field layers, bounded by a memory budget in bytes.
+class FlowFieldCache final
+{
+public:
+	//Constructor & Destructor
+	explicit FlowFieldCache(size_t memoryBudget);
+	~FlowFieldCache() = default;
+
+	//Returns the cached layer and marks it as most recently used, nullptr on a miss
+	std::shared_ptr<const FlowFieldLayer> Find(const FlowFieldKey& key);
+
+	//Adds or replaces a layer, evicts the least recently used layers that don't fit the budget anymore.
+	//A layer bigger than the whole budget is not cached.
+	void Insert(const FlowFieldKey& key, const std::shared_ptr<const FlowFieldLayer>& pLayer);
+
+	void Clear();
+
+	void SetMemoryBudget(size_t memoryBudget);
+	size_t GetMemoryBudget() const { return m_MemoryBudget; }
+	size_t GetMemoryUsed() const { return m_MemoryUsed; }
+	int GetNrOfEntries() const { return int(m_Entries.size()); }
+	int GetNrOfHits() const { return m_NrOfHits; }
+	int GetNrOfMisses() const { return m_NrOfMisses; }
+
+private:
+	struct Entry
+	{
+		FlowFieldKey key;
+		std::shared_ptr<const FlowFieldLayer> pLayer;
+		size_t memorySize;
+	};
+
+	//Datamembers
+	size_t m_MemoryBudget;
+	size_t m_MemoryUsed = 0;
+	int m_NrOfHits = 0;
+	int m_NrOfMisses = 0;
+
+	//Most recently used entry in front
+	std::list<Entry> m_Entries;
+	std::unordered_map<FlowFieldKey, std::list<Entry>::iterator, FlowFieldKeyHash> m_Lookup;
+
+	//Functions
+	void Erase(std::list<Entry>::iterator it);
+	void EvictToBudget();
+
+	//C++ make the class non-copyable
+	FlowFieldCache(const FlowFieldCache&) = delete;
+	FlowFieldCache& operator=(const FlowFieldCache&) = delete;
+};
+#endif
@@ -0,0 +1,73 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include "FlowFieldDensity.h"
+#include "FlowFieldGrid.h"
+
+//Constructor
+FlowFieldDensity::FlowFieldDensity(int columns, int rows, float cellSize)
+	: m_Columns(columns)
+	, m_Rows(rows)
+	, m_CellSize(cellSize)
+	, m_Densities(columns * rows, 0.f)
+	, m_Costs(columns * rows, 0)
+{
+}
+
+//Functions
+void FlowFieldDensity::Splat(const Elite::Vector2* pPositions, int count)
+{
+	std::fill(m_Densities.begin(), m_Densities.end(), 0.f);
+
+	for (int i{}; i < count; i++)
+	{
+		//Same cell center relative coordinates as FlowFieldGrid::SampleDirection
+		const float u = pPositions[i].x / m_CellSize - 0.5f;
+		const float v = pPositions[i].y / m_CellSize - 0.5f;
+		const int col = int(std::floor(u));
+		const int row = int(std::floor(v));
+		const float fractionX = u - col;
+		const float fractionY = v - row;
+
+		const float weightsX[2]{ 1.f - fractionX, fractionX };
+		const float weightsY[2]{ 1.f - fractionY, fractionY };
+
+		//Weight that falls outside the grid is dropped, agents only stand there next to the border walls
+		for (int y{}; y < 2; y++)
+		{
+			const int cellRow{ row + y };
+			if (cellRow < 0 || cellRow >= m_Rows)
+				continue;
+
+			for (int x{}; x < 2; x++)
+			{
+				const int cellCol{ col + x };
+				if (cellCol >= 0 && cellCol < m_Columns)
+					m_Densities[cellRow * m_Columns + cellCol] += weightsX[x] * weightsY[y];
+			}
+		}
+	}
+}
+
+bool FlowFieldDensity::ApplyToCosts(const std::vector<uint8_t>& staticCosts, float weight, float minDensity)
+{
+	bool hasChanged{ false };
+	const int maxCost{ FlowFieldGrid::IMPASSABLE - 1 };
+
+	for (size_t idx{}; idx < m_Costs.size(); idx++)
+	{
+		uint8_t cost{ staticCosts[idx] };
+		if (cost != FlowFieldGrid::IMPASSABLE)
+		{
+			const float densityCost{ weight * (m_Densities[idx] - minDensity) };
+			if (densityCost > 0.f)
+				cost = uint8_t(std::min(maxCost, cost + int(densityCost + 0.5f)));
+		}
+
+		hasChanged |= m_Costs[idx] != cost;
+		m_Costs[idx] = cost;
+	}
+
+	return hasChanged;
+}
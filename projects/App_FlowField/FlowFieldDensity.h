@@ -0,0 +1,47 @@
+#ifndef FLOWFIELD_DENSITY_H
+#define FLOWFIELD_DENSITY_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------------------------------
+// Density Layer
+//-----------------------------------------------------------------
+// Dynamic cost layer in the style of continuum crowds: every agent splats its density
+// bilinearly over the four cells around it, and crowded cells get more expensive on top
+// of the static cost field. Integrating over these costs spreads the crowd over other routes.
+class FlowFieldDensity final
+{
+public:
+	//Constructor & Destructor
+	FlowFieldDensity(int columns, int rows, float cellSize);
+	~FlowFieldDensity() = default;
+
+	//Clears the densities and splats every position, O(cells + agents)
+	void Splat(const Elite::Vector2* pPositions, int count);
+
+	//Costs = static cost + weight * (density - minDensity), walls stay walls and walkable cells stay walkable.
+	//Returns true when at least one cost is different from the previous call.
+	bool ApplyToCosts(const std::vector<uint8_t>& staticCosts, float weight, float minDensity);
+
+	//Agents per cell of the last splat
+	const std::vector<float>& GetDensities() const { return m_Densities; }
+	//Costs of the last ApplyToCosts, has to be called once before this is used
+	const std::vector<uint8_t>& GetCosts() const { return m_Costs; }
+
+private:
+	//Datamembers
+	int m_Columns;
+	int m_Rows;
+	float m_CellSize;
+
+	std::vector<float> m_Densities;
+	std::vector<uint8_t> m_Costs;
+
+	//C++ make the class non-copyable
+	FlowFieldDensity(const FlowFieldDensity&) = delete;
+	FlowFieldDensity& operator=(const FlowFieldDensity&) = delete;
+};
+#endif
@@ -0,0 +1,113 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include "FlowFieldGrid.h"
+
+const uint8_t FlowFieldGrid::IMPASSABLE;
+
+//Constructor
+FlowFieldGrid::FlowFieldGrid(int columns, int rows, float cellSize, uint8_t defaultCost)
+	: m_Columns(columns)
+	, m_Rows(rows)
+	, m_CellSize(cellSize)
+	, m_Costs(columns * rows, defaultCost)
+	, m_Integration(columns * rows, 0)
+	, m_Directions(columns * rows, 0)
+	, m_LineOfSight(columns * rows, 0)
+{
+}
+
+//Functions
+int FlowFieldGrid::GetCellIdxAtWorldPos(const Elite::Vector2& pos) const
+{
+	//int() truncates towards zero, so negative positions need their own check
+	if (pos.x < 0.f || pos.y < 0.f)
+		return -1;
+
+	const int col = int(pos.x / m_CellSize);
+	const int row = int(pos.y / m_CellSize);
+	if (!IsWithinBounds(col, row))
+		return -1;
+
+	return GetIndex(col, row);
+}
+
+Elite::Vector2 FlowFieldGrid::GetCellWorldPos(int idx) const
+{
+	const int col = idx % m_Columns;
+	const int row = idx / m_Columns;
+
+	return Elite::Vector2{ (col + 0.5f) * m_CellSize, (row + 0.5f) * m_CellSize };
+}
+
+Elite::Vector2 FlowFieldGrid::SampleDirection(const std::vector<uint16_t>& directions, const Elite::Vector2& position) const
+{
+	//Position in cell units relative to the cell centers
+	const float u = position.x / m_CellSize - 0.5f;
+	const float v = position.y / m_CellSize - 0.5f;
+	const int col = int(std::floor(u));
+	const int row = int(std::floor(v));
+	const float fractionX = u - col;
+	const float fractionY = v - row;
+
+	const int cols[2]{ Elite::Clamp(col, 0, m_Columns - 1), Elite::Clamp(col + 1, 0, m_Columns - 1) };
+	const int rows[2]{ Elite::Clamp(row, 0, m_Rows - 1), Elite::Clamp(row + 1, 0, m_Rows - 1) };
+	const float weightsX[2]{ 1.f - fractionX, fractionX };
+	const float weightsY[2]{ 1.f - fractionY, fractionY };
+
+	//Cells without a direction don't pull the result towards zero
+	Elite::Vector2 direction{};
+	float totalWeight{};
+	for (int y{}; y < 2; y++)
+	{
+		for (int x{}; x < 2; x++)
+		{
+			const uint16_t packedDirection = directions[rows[y] * m_Columns + cols[x]];
+			if (packedDirection == 0)
+				continue;
+
+			const float weight = weightsX[x] * weightsY[y];
+			direction += UnpackDirection(packedDirection) * weight;
+			totalWeight += weight;
+		}
+	}
+
+	if (totalWeight <= 0.f)
+		return Elite::ZeroVector2;
+
+	return direction / totalWeight;
+}
+
+void FlowFieldGrid::SampleDirections(const std::vector<uint16_t>& directions, const Elite::Vector2* pPositions, Elite::Vector2* pDirections, int count) const
+{
+	for (int i{}; i < count; i++)
+	{
+		pDirections[i] = SampleDirection(directions, pPositions[i]);
+	}
+}
+
+size_t FlowFieldGrid::GetMemorySize() const
+{
+	return sizeof(FlowFieldGrid)
+		+ m_Costs.capacity() * sizeof(uint8_t)
+		+ m_Integration.capacity() * sizeof(int)
+		+ m_Directions.capacity() * sizeof(uint16_t)
+		+ m_LineOfSight.capacity() * sizeof(uint8_t);
+}
+
+uint16_t FlowFieldGrid::PackDirection(const Elite::Vector2& direction)
+{
+	const int8_t x = int8_t(std::round(Elite::Clamp(direction.x, -1.f, 1.f) * 127.f));
+	const int8_t y = int8_t(std::round(Elite::Clamp(direction.y, -1.f, 1.f) * 127.f));
+
+	return uint16_t(uint8_t(x) | (uint16_t(uint8_t(y)) << 8));
+}
+
+Elite::Vector2 FlowFieldGrid::UnpackDirection(uint16_t packedDirection)
+{
+	const int8_t x = int8_t(packedDirection & 0xFF);
+	const int8_t y = int8_t(packedDirection >> 8);
+
+	return Elite::Vector2{ x / 127.f, y / 127.f };
+}
@@ -0,0 +1,86 @@
+#ifndef FLOWFIELD_GRID_H
+#define FLOWFIELD_GRID_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------------------------------
+// Flow Field Grid
+//-----------------------------------------------------------------
+// Dense, row-major storage for the cost, integration and flow fields.
+// Every field is its own contiguous array (structure of arrays), a cell is an index
+// into them: 1 byte of cost, 4 bytes of integration, 2 bytes of direction and 1 byte of line of sight.
+class FlowFieldGrid final
+{
+public:
+	//Cost of walls, every cost from 1 to 254 is walkable terrain
+	static const uint8_t IMPASSABLE = 255;
+
+	//Constructor & Destructor
+	FlowFieldGrid(int columns, int rows, float cellSize, uint8_t defaultCost = 1);
+	~FlowFieldGrid() = default;
+
+	//Layout
+	int GetColumns() const { return m_Columns; }
+	int GetRows() const { return m_Rows; }
+	int GetNrOfCells() const { return m_Columns * m_Rows; }
+	float GetCellSize() const { return m_CellSize; }
+	int GetIndex(int col, int row) const { return row * m_Columns + col; }
+	bool IsWithinBounds(int col, int row) const { return col >= 0 && col < m_Columns && row >= 0 && row < m_Rows; }
+
+	//Returns -1 outside the grid
+	int GetCellIdxAtWorldPos(const Elite::Vector2& pos) const;
+	//Center of the cell in world space
+	Elite::Vector2 GetCellWorldPos(int idx) const;
+
+	//Cost field
+	uint8_t GetCost(int idx) const { return m_Costs[idx]; }
+	void SetCost(int idx, uint8_t cost) { m_Costs[idx] = cost; }
+	bool IsTraversable(int idx) const { return m_Costs[idx] != IMPASSABLE; }
+	const std::vector<uint8_t>& GetCosts() const { return m_Costs; }
+
+	//Integration field
+	int GetIntegrationCost(int idx) const { return m_Integration[idx]; }
+	std::vector<int>& GetIntegration() { return m_Integration; }
+	const std::vector<int>& GetIntegration() const { return m_Integration; }
+
+	//Flow field
+	Elite::Vector2 GetDirection(int idx) const { return UnpackDirection(m_Directions[idx]); }
+	void SetDirection(int idx, const Elite::Vector2& direction) { m_Directions[idx] = PackDirection(direction); }
+	std::vector<uint16_t>& GetDirections() { return m_Directions; }
+	const std::vector<uint16_t>& GetDirections() const { return m_Directions; }
+
+	//Line of sight field, 1 when the goal can be walked to in a straight line
+	bool HasLineOfSight(int idx) const { return m_LineOfSight[idx] != 0; }
+	std::vector<uint8_t>& GetLineOfSight() { return m_LineOfSight; }
+	const std::vector<uint8_t>& GetLineOfSight() const { return m_LineOfSight; }
+
+	//Bilinear blend of the directions of the four cells around the position, walls and the goal are left out.
+	//The result is not normalized, it gets shorter where the directions disagree (near the goal).
+	Elite::Vector2 SampleDirection(const Elite::Vector2& position) const { return SampleDirection(m_Directions, position); }
+	Elite::Vector2 SampleDirection(const std::vector<uint16_t>& directions, const Elite::Vector2& position) const;
+
+	//Batch version for a whole array of positions
+	void SampleDirections(const std::vector<uint16_t>& directions, const Elite::Vector2* pPositions, Elite::Vector2* pDirections, int count) const;
+
+	//Bytes used by all fields together
+	size_t GetMemorySize() const;
+
+	//Unit directions are stored as two signed bytes, x in the low and y in the high byte
+	static uint16_t PackDirection(const Elite::Vector2& direction);
+	static Elite::Vector2 UnpackDirection(uint16_t packedDirection);
+
+private:
+	//Datamembers
+	int m_Columns;
+	int m_Rows;
+	float m_CellSize;
+
+	std::vector<uint8_t> m_Costs;
+	std::vector<int> m_Integration;
+	std::vector<uint16_t> m_Directions;
+	std::vector<uint8_t> m_LineOfSight;
+};
+#endif
@@ -0,0 +1,101 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include "FlowFieldGroups.h"
+
+//Constructor
+FlowFieldGroups::FlowFieldGroups(int columns, int rows, bool isConnectedDiagonally, int costStraight, int costDiagonal, int nonTraversable)
+	: m_Columns(columns)
+	, m_Rows(rows)
+	, m_IsConnectedDiagonally(isConnectedDiagonally)
+	, m_CostStraight(costStraight)
+	, m_CostDiagonal(costDiagonal)
+	, m_NonTraversable(nonTraversable)
+{
+}
+
+//Functions
+void FlowFieldGroups::SetNrOfGroups(int nrOfGroups)
+{
+	m_Groups.resize(nrOfGroups, { -1, { -1, 0, 0 }, nullptr });
+}
+
+int FlowFieldGroups::Update(IntegrationMode mode, const std::vector<uint8_t>& costs, unsigned int costVersion, FlowFieldCache& cache, Elite::EThreadPool* pThreadPool)
+{
+	m_BuildKeys.clear();
+	for (Group& group : m_Groups)
+	{
+		if (group.goalIdx == -1)
+		{
+			group.pLayer = nullptr;
+			continue;
+		}
+
+		const FlowFieldKey key{ group.goalIdx, costVersion, int(mode) };
+		if (group.pLayer && group.key == key)
+			continue;
+
+		group.key = key;
+		group.pLayer = cache.Find(key);
+		if (!group.pLayer && std::find(m_BuildKeys.begin(), m_BuildKeys.end(), key) == m_BuildKeys.end())
+			m_BuildKeys.push_back(key);
+	}
+
+	const int nrOfBuilds{ int(m_BuildKeys.size()) };
+	if (nrOfBuilds == 0)
+		return 0;
+
+	//One group per job, the integration itself stays single threaded because the pool can't nest
+	m_BuiltLayers.assign(nrOfBuilds, nullptr);
+	auto buildJob = [this, mode, &costs](int buildIdx)
+	{
+		FlowFieldIntegrator* pIntegrator = AcquireIntegrator();
+		m_BuiltLayers[buildIdx] = FlowFieldBuilder::BuildLayer(*pIntegrator, mode, costs, m_BuildKeys[buildIdx].goalIdx);
+		ReleaseIntegrator(pIntegrator);
+	};
+
+	if (pThreadPool)
+	{
+		pThreadPool->ParallelFor(nrOfBuilds, buildJob);
+	}
+	else
+	{
+		for (int buildIdx{}; buildIdx < nrOfBuilds; buildIdx++)
+			buildJob(buildIdx);
+	}
+
+	for (int buildIdx{}; buildIdx < nrOfBuilds; buildIdx++)
+	{
+		cache.Insert(m_BuildKeys[buildIdx], m_BuiltLayers[buildIdx]);
+
+		for (Group& group : m_Groups)
+		{
+			if (!group.pLayer && group.key == m_BuildKeys[buildIdx])
+				group.pLayer = m_BuiltLayers[buildIdx];
+		}
+	}
+
+	m_BuiltLayers.clear();
+	return nrOfBuilds;
+}
+
+FlowFieldIntegrator* FlowFieldGroups::AcquireIntegrator()
+{
+	std::lock_guard<std::mutex> lock(m_IntegratorMutex);
+	if (m_FreeIntegrators.empty())
+	{
+		m_Integrators.push_back(std::make_unique<FlowFieldIntegrator>(m_Columns, m_Rows, m_IsConnectedDiagonally, m_CostStraight, m_CostDiagonal, m_NonTraversable));
+		return m_Integrators.back().get();
+	}
+
+	FlowFieldIntegrator* pIntegrator = m_FreeIntegrators.back();
+	m_FreeIntegrators.pop_back();
+	return pIntegrator;
+}
+
+void FlowFieldGroups::ReleaseIntegrator(FlowFieldIntegrator* pIntegrator)
+{
+	std::lock_guard<std::mutex> lock(m_IntegratorMutex);
+	m_FreeIntegrators.push_back(pIntegrator);
+}
@@ -0,0 +1,75 @@
+#ifndef FLOWFIELD_GROUPS_H
+#define FLOWFIELD_GROUPS_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "FlowFieldBuilder.h"
+#include "FlowFieldCache.h"
+
+//-----------------------------------------------------------------
+// Group Manager
+//-----------------------------------------------------------------
+// Flow fields for several groups of agents, each with its own goal, over one shared cost field.
+// Fields that went stale are built together in one batch, in parallel on the thread pool.
+// Groups with the same goal point to the same layer, and layers go through the field cache,
+// so a goal that another group or the main field already has costs no memory or time.
+class FlowFieldGroups final
+{
+public:
+	//Constructor & Destructor
+	FlowFieldGroups(int columns, int rows, bool isConnectedDiagonally, int costStraight, int costDiagonal, int nonTraversable);
+	~FlowFieldGroups() = default;
+
+	//New groups start without a goal, removed groups drop their layer
+	void SetNrOfGroups(int nrOfGroups);
+	int GetNrOfGroups() const { return int(m_Groups.size()); }
+
+	void SetGoal(int groupIdx, int goalIdx) { m_Groups[groupIdx].goalIdx = goalIdx; }
+	int GetGoal(int groupIdx) const { return m_Groups[groupIdx].goalIdx; }
+
+	//Gives every group with a goal the layer for its goal, the cost version and the mode.
+	//Missing layers are built in one batch, returns how many were built.
+	int Update(IntegrationMode mode, const std::vector<uint8_t>& costs, unsigned int costVersion, FlowFieldCache& cache, Elite::EThreadPool* pThreadPool);
+
+	//Layer of the last Update, nullptr for a group without a goal
+	const FlowFieldLayer* GetLayer(int groupIdx) const { return m_Groups[groupIdx].pLayer.get(); }
+
+private:
+	struct Group
+	{
+		int goalIdx;
+		FlowFieldKey key;
+		std::shared_ptr<const FlowFieldLayer> pLayer;
+	};
+
+	//Datamembers
+	int m_Columns;
+	int m_Rows;
+	bool m_IsConnectedDiagonally;
+	int m_CostStraight;
+	int m_CostDiagonal;
+	int m_NonTraversable;
+
+	std::vector<Group> m_Groups;
+
+	//Scratch of one batch, every key is built once no matter how many groups need it
+	std::vector<FlowFieldKey> m_BuildKeys;
+	std::vector<std::shared_ptr<const FlowFieldLayer>> m_BuiltLayers;
+
+	//Integrators keep scratch state, every parallel build takes one for itself
+	std::vector<std::unique_ptr<FlowFieldIntegrator>> m_Integrators;
+	std::vector<FlowFieldIntegrator*> m_FreeIntegrators;
+	std::mutex m_IntegratorMutex;
+
+	//Functions
+	FlowFieldIntegrator* AcquireIntegrator();
+	void ReleaseIntegrator(FlowFieldIntegrator* pIntegrator);
+
+	//C++ make the class non-copyable
+	FlowFieldGroups(const FlowFieldGroups&) = delete;
+	FlowFieldGroups& operator=(const FlowFieldGroups&) = delete;
+};
+#endif
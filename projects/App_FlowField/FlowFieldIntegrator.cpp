@@ -0,0 +1,807 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include "FlowFieldIntegrator.h"
+
+const int FlowFieldIntegrator::UNREACHABLE;
+
+//Constructor
+FlowFieldIntegrator::FlowFieldIntegrator(int columns, int rows, bool isConnectedDiagonally, int costStraight, int costDiagonal, int nonTraversable)
+	: m_Columns(columns)
+	, m_Rows(rows)
+	, m_NonTraversable(nonTraversable)
+	, m_OpenStamps(columns * rows, 0)
+	, m_ClosedStamps(columns * rows, 0)
+	, m_Queue(columns * rows, 0)
+{
+	//An undirected GridGraph ends up with the connections of a cell ordered like this,
+	//keeping the order makes ties resolve exactly like they did on the graph
+	m_Neighbours.push_back({ -1, -1, costDiagonal });
+	m_Neighbours.push_back({ 0, -1, costStraight });
+	m_Neighbours.push_back({ 1, -1, costDiagonal });
+	m_Neighbours.push_back({ -1, 0, costStraight });
+	m_Neighbours.push_back({ 1, 0, costStraight });
+	m_Neighbours.push_back({ 0, 1, costStraight });
+	m_Neighbours.push_back({ 1, 1, costDiagonal });
+	m_Neighbours.push_back({ -1, 1, costDiagonal });
+
+	if (!isConnectedDiagonally)
+	{
+		auto isDiagonal = [](const NeighbourOffset& offset) { return offset.col != 0 && offset.row != 0; };
+		m_Neighbours.erase(std::remove_if(m_Neighbours.begin(), m_Neighbours.end(), isDiagonal), m_Neighbours.end());
+	}
+
+	for (const NeighbourOffset& offset : m_Neighbours)
+	{
+		m_NeighbourDirections.push_back(FlowFieldGrid::PackDirection(Elite::Vector2{ float(offset.col), float(offset.row) }.GetNormalized()));
+	}
+}
+
+//Functions
+void FlowFieldIntegrator::Integrate(IntegrationMode mode, const std::vector<uint8_t>& costs, int goalIdx, std::vector<int>& integration)
+{
+	switch (mode)
+	{
+	case IntegrationMode::Dijkstra:
+		if (m_pThreadPool)
+			IntegrateDijkstraParallel(costs, goalIdx, integration, *m_pThreadPool);
+		else
+			IntegrateDijkstra(costs, goalIdx, integration);
+		break;
+	case IntegrationMode::Eikonal:
+		IntegrateEikonal(costs, goalIdx, m_ArrivalTimes);
+		integration.resize(m_ArrivalTimes.size());
+		for (size_t i{}; i < m_ArrivalTimes.size(); i++)
+		{
+			integration[i] = m_ArrivalTimes[i] < FLT_MAX ? int(m_ArrivalTimes[i] + 0.5f) : UNREACHABLE;
+		}
+		break;
+	case IntegrationMode::BFS:
+	default:
+		IntegrateBFS(costs, goalIdx, integration);
+		break;
+	}
+}
+
+void FlowFieldIntegrator::IntegrateBFS(const std::vector<uint8_t>& costs, int goalIdx, std::vector<int>& integration)
+{
+	const int nrOfCells = GetNrOfCells();
+	integration.assign(nrOfCells, UNREACHABLE);
+
+	if (goalIdx < 0 || goalIdx >= nrOfCells)
+		return;
+
+	NextGeneration();
+
+	integration[goalIdx] = 0;
+	m_OpenStamps[goalIdx] = m_Generation;
+	PushQueue(goalIdx);
+
+	while (m_QueueCount > 0)
+	{
+		const int currentIdx = PopQueue();
+		const int currentCol = currentIdx % m_Columns;
+		const int currentRow = currentIdx / m_Columns;
+		const int currentCost = integration[currentIdx];
+
+		for (const NeighbourOffset& offset : m_Neighbours)
+		{
+			const int col = currentCol + offset.col;
+			const int row = currentRow + offset.row;
+			if (col < 0 || col >= m_Columns || row < 0 || row >= m_Rows)
+				continue;
+
+			const int nextIdx = row * m_Columns + col;
+			if (costs[nextIdx] >= m_NonTraversable || m_ClosedStamps[nextIdx] == m_Generation)
+				continue;
+
+			const int integrationCost = currentCost + offset.cost + costs[nextIdx];
+			if (integration[nextIdx] > integrationCost)
+				integration[nextIdx] = integrationCost;
+
+			if (m_OpenStamps[nextIdx] != m_Generation)
+			{
+				m_OpenStamps[nextIdx] = m_Generation;
+				PushQueue(nextIdx);
+			}
+		}
+
+		m_ClosedStamps[currentIdx] = m_Generation;
+	}
+}
+
+void FlowFieldIntegrator::IntegrateDijkstra(const std::vector<uint8_t>& costs, int goalIdx, std::vector<int>& integration)
+{
+	const int nrOfCells = GetNrOfCells();
+	integration.assign(nrOfCells, UNREACHABLE);
+
+	if (goalIdx < 0 || goalIdx >= nrOfCells)
+		return;
+
+	m_Heap.Clear();
+
+	integration[goalIdx] = 0;
+	m_Heap.Push(0, goalIdx);
+
+	PropagateDijkstra(costs, integration, false);
+}
+
+void FlowFieldIntegrator::IntegrateDijkstraParallel(const std::vector<uint8_t>& costs, int goalIdx, std::vector<int>& integration, Elite::EThreadPool& threadPool)
+{
+	const int nrOfCells = GetNrOfCells();
+	integration.assign(nrOfCells, UNREACHABLE);
+
+	if (goalIdx < 0 || goalIdx >= nrOfCells)
+		return;
+
+	//Two bands per thread so both phases keep every thread busy
+	const int nrOfBands = std::min(m_Rows, int(threadPool.GetNrOfThreads()) * 2);
+	if (int(m_Bands.size()) != nrOfBands)
+		m_Bands = std::vector<Band>(nrOfBands);
+
+	for (int i{}; i < nrOfBands; i++)
+	{
+		m_Bands[i].firstRow = i * m_Rows / nrOfBands;
+		m_Bands[i].endRow = (i + 1) * m_Rows / nrOfBands;
+		m_Bands[i].hasChanged = true;
+	}
+
+	integration[goalIdx] = 0;
+
+	//Bands of the same parity never touch, so they can run together without locks.
+	//Integer shortest paths have a single fixed point, so the result matches the single threaded one.
+	bool isFirstPass{ true };
+	bool hasChanged{ true };
+	std::vector<int> bandsToRelax{};
+	while (hasChanged)
+	{
+		hasChanged = false;
+		for (int parity{}; parity < 2; parity++)
+		{
+			//Only bands next to a band that changed can improve
+			bandsToRelax.clear();
+			for (int i{ parity }; i < nrOfBands; i += 2)
+			{
+				const bool isPreviousChanged = i > 0 && m_Bands[i - 1].hasChanged;
+				const bool isNextChanged = i < nrOfBands - 1 && m_Bands[i + 1].hasChanged;
+				if (isFirstPass || isPreviousChanged || isNextChanged)
+					bandsToRelax.push_back(i);
+			}
+
+			threadPool.ParallelFor(int(bandsToRelax.size()), [&](int i)
+			{
+				RelaxBand(costs, goalIdx, integration, m_Bands[bandsToRelax[i]], isFirstPass);
+			});
+
+			for (int bandIdx : bandsToRelax)
+				hasChanged = hasChanged || m_Bands[bandIdx].hasChanged;
+		}
+
+		isFirstPass = false;
+	}
+}
+
+void FlowFieldIntegrator::RelaxBand(const std::vector<uint8_t>& costs, int goalIdx, std::vector<int>& integration, Band& band, bool isFirstPass) const
+{
+	band.hasChanged = false;
+	band.heap.Clear();
+
+	if (isFirstPass && goalIdx / m_Columns >= band.firstRow && goalIdx / m_Columns < band.endRow)
+		band.heap.Push(0, goalIdx);
+
+	//Seed with the cells that got cheaper through the rows of the neighbouring bands
+	const int borderRows[2]{ band.firstRow, band.endRow - 1 };
+	for (int borderIdx{}; borderIdx < 2; borderIdx++)
+	{
+		const int row = borderRows[borderIdx];
+		if (borderIdx == 1 && row == band.firstRow)
+			break;
+
+		for (int col{}; col < m_Columns; col++)
+		{
+			const int idx = row * m_Columns + col;
+			if (costs[idx] >= m_NonTraversable)
+				continue;
+
+			for (const NeighbourOffset& offset : m_Neighbours)
+			{
+				const int neighbourCol = col + offset.col;
+				const int neighbourRow = row + offset.row;
+				if (neighbourCol < 0 || neighbourCol >= m_Columns || neighbourRow < 0 || neighbourRow >= m_Rows)
+					continue;
+				if (neighbourRow >= band.firstRow && neighbourRow < band.endRow)
+					continue;
+
+				const int neighbourCost = integration[neighbourRow * m_Columns + neighbourCol];
+				if (neighbourCost >= UNREACHABLE)
+					continue;
+
+				const int integrationCost = neighbourCost + offset.cost + costs[idx];
+				if (integrationCost < integration[idx])
+				{
+					integration[idx] = integrationCost;
+					band.heap.Push(static_cast<unsigned int>(integrationCost), idx);
+					band.hasChanged = true;
+				}
+			}
+		}
+	}
+
+	//Dijkstra that stays inside the band
+	while (!band.heap.IsEmpty())
+	{
+		const auto entry = band.heap.Pop();
+		const int currentIdx = entry.value;
+		const int currentCost = integration[currentIdx];
+		if (int(entry.key) != currentCost)
+			continue;
+
+		const int currentCol = currentIdx % m_Columns;
+		const int currentRow = currentIdx / m_Columns;
+
+		for (const NeighbourOffset& offset : m_Neighbours)
+		{
+			const int col = currentCol + offset.col;
+			const int row = currentRow + offset.row;
+			if (col < 0 || col >= m_Columns || row < band.firstRow || row >= band.endRow)
+				continue;
+
+			const int nextIdx = row * m_Columns + col;
+			if (costs[nextIdx] >= m_NonTraversable)
+				continue;
+
+			const int integrationCost = currentCost + offset.cost + costs[nextIdx];
+			if (integrationCost < integration[nextIdx])
+			{
+				integration[nextIdx] = integrationCost;
+				band.heap.Push(static_cast<unsigned int>(integrationCost), nextIdx);
+				band.hasChanged = true;
+			}
+		}
+	}
+}
+
+void FlowFieldIntegrator::IntegrateDijkstra(const std::vector<uint8_t>& costs, const std::vector<std::pair<int, int>>& seeds, std::vector<int>& integration)
+{
+	const int nrOfCells = GetNrOfCells();
+	integration.assign(nrOfCells, UNREACHABLE);
+
+	m_Heap.Clear();
+
+	for (const auto& seed : seeds)
+	{
+		if (seed.first < 0 || seed.first >= nrOfCells || seed.second >= integration[seed.first])
+			continue;
+
+		integration[seed.first] = seed.second;
+		m_Heap.Push(static_cast<unsigned int>(seed.second), seed.first);
+	}
+
+	PropagateDijkstra(costs, integration, false);
+}
+
+bool FlowFieldIntegrator::RepairDijkstra(const std::vector<uint8_t>& costs, int goalIdx, int changedIdx, int oldCost, std::vector<int>& integration, std::vector<int>& changedCells)
+{
+	changedCells.clear();
+
+	const int nrOfCells = GetNrOfCells();
+	if (int(integration.size()) != nrOfCells || goalIdx < 0 || goalIdx >= nrOfCells || changedIdx < 0 || changedIdx >= nrOfCells)
+		return false;
+
+	//The goal always has cost 0, changing it changes the sources of the whole field
+	if (changedIdx == goalIdx)
+		return false;
+
+	const int newCost = costs[changedIdx];
+	if (newCost == oldCost)
+		return true;
+
+	//Open stamps mark touched cells for this repair
+	NextGeneration();
+	m_RepairTouched.clear();
+	m_Heap.Clear();
+
+	if (newCost > oldCost)
+	{
+		//Invalidate the changed cell and every cell whose cheapest path could lead through it:
+		//a neighbour depends on a cell when its cost equals the cell's cost plus the step towards it.
+		//m_RepairTouched doubles as the work list, it still holds the costs from before the change.
+		TouchRepairCell(integration, changedIdx);
+		for (size_t i{}; i < m_RepairTouched.size(); i++)
+		{
+			const int currentIdx = m_RepairTouched[i].first;
+			const int currentCost = m_RepairTouched[i].second;
+			if (currentCost >= UNREACHABLE)
+				continue;
+
+			const int currentCol = currentIdx % m_Columns;
+			const int currentRow = currentIdx / m_Columns;
+			for (const NeighbourOffset& offset : m_Neighbours)
+			{
+				const int col = currentCol + offset.col;
+				const int row = currentRow + offset.row;
+				if (col < 0 || col >= m_Columns || row < 0 || row >= m_Rows)
+					continue;
+
+				const int nextIdx = row * m_Columns + col;
+				if (m_OpenStamps[nextIdx] == m_Generation || nextIdx == goalIdx || costs[nextIdx] >= m_NonTraversable)
+					continue;
+
+				if (integration[nextIdx] == currentCost + offset.cost + costs[nextIdx])
+					TouchRepairCell(integration, nextIdx);
+			}
+		}
+
+		for (const auto& touched : m_RepairTouched)
+			integration[touched.first] = UNREACHABLE;
+
+		//Re-seed the invalidated cells from their valid neighbours
+		for (const auto& touched : m_RepairTouched)
+		{
+			const int idx = touched.first;
+			if (costs[idx] >= m_NonTraversable)
+				continue;
+
+			const int integrationCost = GetCheapestNeighbourCost(costs, integration, idx);
+			if (integrationCost < UNREACHABLE)
+			{
+				integration[idx] = integrationCost;
+				m_Heap.Push(static_cast<unsigned int>(integrationCost), idx);
+			}
+		}
+	}
+	else if (newCost < m_NonTraversable)
+	{
+		//Cheaper cell, only the cell itself and the cells that improve through it change
+		const int integrationCost = GetCheapestNeighbourCost(costs, integration, changedIdx);
+		if (integrationCost < integration[changedIdx])
+		{
+			TouchRepairCell(integration, changedIdx);
+			integration[changedIdx] = integrationCost;
+			m_Heap.Push(static_cast<unsigned int>(integrationCost), changedIdx);
+		}
+	}
+
+	PropagateDijkstra(costs, integration, true);
+
+	for (const auto& touched : m_RepairTouched)
+	{
+		if (integration[touched.first] != touched.second)
+			changedCells.push_back(touched.first);
+	}
+
+	return true;
+}
+
+void FlowFieldIntegrator::IntegrateEikonal(const std::vector<uint8_t>& costs, int goalIdx, std::vector<float>& arrivalTimes)
+{
+	const int nrOfCells = GetNrOfCells();
+	arrivalTimes.assign(nrOfCells, FLT_MAX);
+
+	if (goalIdx < 0 || goalIdx >= nrOfCells)
+		return;
+
+	//Closed stamps mark cells whose arrival time is final (known)
+	NextGeneration();
+	m_TrialHeap.clear();
+
+	arrivalTimes[goalIdx] = 0.f;
+	m_TrialHeap.push_back({ 0.f, goalIdx });
+
+	const int straightOffsets[4][2]{ { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 } };
+	while (!m_TrialHeap.empty())
+	{
+		std::pop_heap(m_TrialHeap.begin(), m_TrialHeap.end(), std::greater<std::pair<float, int>>());
+		const int currentIdx = m_TrialHeap.back().second;
+		m_TrialHeap.pop_back();
+
+		if (m_ClosedStamps[currentIdx] == m_Generation)
+			continue;
+		m_ClosedStamps[currentIdx] = m_Generation;
+
+		const int currentCol = currentIdx % m_Columns;
+		const int currentRow = currentIdx / m_Columns;
+
+		for (const auto& offset : straightOffsets)
+		{
+			const int col = currentCol + offset[0];
+			const int row = currentRow + offset[1];
+			if (col < 0 || col >= m_Columns || row < 0 || row >= m_Rows)
+				continue;
+
+			const int nextIdx = row * m_Columns + col;
+			if (costs[nextIdx] >= m_NonTraversable || m_ClosedStamps[nextIdx] == m_Generation)
+				continue;
+
+			const float arrivalTime = SolveEikonal(costs, arrivalTimes, nextIdx);
+			if (arrivalTime < arrivalTimes[nextIdx])
+			{
+				arrivalTimes[nextIdx] = arrivalTime;
+				m_TrialHeap.push_back({ arrivalTime, nextIdx });
+				std::push_heap(m_TrialHeap.begin(), m_TrialHeap.end(), std::greater<std::pair<float, int>>());
+			}
+		}
+	}
+}
+
+void FlowFieldIntegrator::CalculateGradientDirections(const std::vector<float>& arrivalTimes, std::vector<uint16_t>& directions) const
+{
+	directions.assign(arrivalTimes.size(), 0);
+
+	for (int row{}; row < m_Rows; row++)
+	{
+		for (int col{}; col < m_Columns; col++)
+		{
+			const int idx = row * m_Columns + col;
+			const float arrivalTime = arrivalTimes[idx];
+			if (arrivalTime == FLT_MAX)
+				continue;
+
+			//One sided difference towards the lower neighbour on each axis (upwind)
+			const float left = col > 0 ? arrivalTimes[idx - 1] : FLT_MAX;
+			const float right = col < m_Columns - 1 ? arrivalTimes[idx + 1] : FLT_MAX;
+			const float down = row > 0 ? arrivalTimes[idx - m_Columns] : FLT_MAX;
+			const float up = row < m_Rows - 1 ? arrivalTimes[idx + m_Columns] : FLT_MAX;
+
+			Elite::Vector2 gradient{};
+			if (std::min(left, right) < arrivalTime)
+				gradient.x = left < right ? arrivalTime - left : right - arrivalTime;
+			if (std::min(down, up) < arrivalTime)
+				gradient.y = down < up ? arrivalTime - down : up - arrivalTime;
+
+			if (gradient != Elite::ZeroVector2)
+				directions[idx] = FlowFieldGrid::PackDirection((-gradient).GetNormalized());
+		}
+	}
+}
+
+void FlowFieldIntegrator::CalculateNeighbourDirections(const std::vector<uint8_t>& costs, const std::vector<int>& integration, int goalIdx, std::vector<uint16_t>& directions)
+{
+	const int nrOfCells = GetNrOfCells();
+	directions.resize(nrOfCells);
+
+	if (m_UseSimd && IsSimdSupported())
+	{
+		PadIntegration(integration);
+		CalculateNeighbourDirectionsSimd(costs, goalIdx, directions);
+		return;
+	}
+
+	for (int idx{}; idx < nrOfCells; idx++)
+	{
+		directions[idx] = CalculateNeighbourDirection(costs, integration, goalIdx, idx);
+	}
+}
+
+uint16_t FlowFieldIntegrator::CalculateNeighbourDirection(const std::vector<uint8_t>& costs, const std::vector<int>& integration, int goalIdx, int idx) const
+{
+	if (idx == goalIdx || costs[idx] >= m_NonTraversable)
+		return 0;
+
+	const int col = idx % m_Columns;
+	const int row = idx / m_Columns;
+
+	//Strictly lower wins, so ties go to the first neighbour in GridGraph order
+	int lowestCost{ INT_MAX };
+	const NeighbourOffset* pLowestOffset{ nullptr };
+	for (const NeighbourOffset& offset : m_Neighbours)
+	{
+		const int nextCol = col + offset.col;
+		const int nextRow = row + offset.row;
+		if (nextCol < 0 || nextCol >= m_Columns || nextRow < 0 || nextRow >= m_Rows)
+			continue;
+
+		const int nextCost = integration[nextRow * m_Columns + nextCol];
+		if (nextCost < lowestCost)
+		{
+			lowestCost = nextCost;
+			pLowestOffset = &offset;
+		}
+	}
+
+	if (!pLowestOffset)
+		return 0;
+
+	return m_NeighbourDirections[pLowestOffset - m_Neighbours.data()];
+}
+
+void FlowFieldIntegrator::CalculateLineOfSight(const std::vector<uint8_t>& costs, int goalIdx, std::vector<uint8_t>& lineOfSight) const
+{
+	lineOfSight.assign(GetNrOfCells(), 0);
+	if (goalIdx < 0 || goalIdx >= GetNrOfCells() || costs[goalIdx] >= m_NonTraversable)
+		return;
+
+	const int goalCol{ goalIdx % m_Columns };
+	const int goalRow{ goalIdx / m_Columns };
+	const int maxDistance{ std::max(std::max(goalCol, m_Columns - 1 - goalCol), std::max(goalRow, m_Rows - 1 - goalRow)) };
+	lineOfSight[goalIdx] = 1;
+
+	//Octant o maps (depth, offset) to (depth * xx + offset * xy, depth * yx + offset * yy)
+	static const int octants[8][4]
+	{
+		{ 1, 0, 0, 1 }, { 0, 1, 1, 0 }, { 0, -1, 1, 0 }, { -1, 0, 0, 1 },
+		{ -1, 0, 0, -1 }, { 0, -1, -1, 0 }, { 0, 1, -1, 0 }, { 1, 0, 0, -1 }
+	};
+
+	//Slope ranges (offset / depth) that no blocked cell closer to the goal covers yet
+	std::vector<std::pair<float, float>> openSlopes;
+	std::vector<std::pair<float, float>> blockedSlopes;
+	std::vector<std::pair<float, float>> remainingSlopes;
+
+	for (const int* octant : octants)
+	{
+		openSlopes.assign(1, { 0.f, 1.f });
+
+		for (int depth{ 1 }; depth <= maxDistance && !openSlopes.empty(); depth++)
+		{
+			blockedSlopes.clear();
+			for (int offset{}; offset <= depth; offset++)
+			{
+				const int col{ goalCol + depth * octant[0] + offset * octant[1] };
+				const int row{ goalRow + depth * octant[2] + offset * octant[3] };
+				if (col < 0 || col >= m_Columns || row < 0 || row >= m_Rows)
+					continue;
+
+				//Only walls block the line, expensive cells like crowded ones can still be walked through
+				const int idx{ row * m_Columns + col };
+				if (costs[idx] >= m_NonTraversable)
+				{
+					//Cells of the same ring never hide each other, so the shadow only starts at the next one
+					blockedSlopes.push_back({ (offset - 0.5f) / (depth + 0.5f), (offset + 0.5f) / (depth - 0.5f) });
+					continue;
+				}
+
+				const float slope{ float(offset) / depth };
+				for (const std::pair<float, float>& open : openSlopes)
+				{
+					if (slope >= open.first && slope <= open.second)
+					{
+						lineOfSight[idx] = 1;
+						break;
+					}
+				}
+			}
+
+			//Cut the shadows out, a range that shrinks to a point is a line squeezing between two corners
+			for (const std::pair<float, float>& blocked : blockedSlopes)
+			{
+				remainingSlopes.clear();
+				for (const std::pair<float, float>& open : openSlopes)
+				{
+					if (blocked.first - open.first > FLT_EPSILON)
+						remainingSlopes.push_back({ open.first, std::min(open.second, blocked.first) });
+					if (open.second - blocked.second > FLT_EPSILON)
+						remainingSlopes.push_back({ std::max(open.first, blocked.second), open.second });
+				}
+				openSlopes.swap(remainingSlopes);
+			}
+		}
+	}
+}
+
+bool FlowFieldIntegrator::IsSimdSupported()
+{
+#ifdef FLOWFIELD_SSE2
+	return true;
+#else
+	return false;
+#endif
+}
+
+void FlowFieldIntegrator::PadIntegration(const std::vector<int>& integration)
+{
+	const int paddedColumns = m_Columns + 2;
+	m_PaddedIntegration.assign(paddedColumns * (m_Rows + 2), INT_MAX);
+
+	for (int row{}; row < m_Rows; row++)
+	{
+		std::copy(integration.begin() + row * m_Columns, integration.begin() + (row + 1) * m_Columns, m_PaddedIntegration.begin() + (row + 1) * paddedColumns + 1);
+	}
+}
+
+void FlowFieldIntegrator::CalculateNeighbourDirectionsSimd(const std::vector<uint8_t>& costs, int goalIdx, std::vector<uint16_t>& directions) const
+{
+#ifdef FLOWFIELD_SSE2
+	const int paddedColumns = m_Columns + 2;
+	const int nrOfNeighbours = int(m_Neighbours.size());
+
+	int neighbourStrides[8]{};
+	for (int i{}; i < nrOfNeighbours; i++)
+	{
+		neighbourStrides[i] = m_Neighbours[i].row * paddedColumns + m_Neighbours[i].col;
+	}
+
+	alignas(16) int lowestNeighbours[4]{};
+	for (int row{}; row < m_Rows; row++)
+	{
+		const int* pRow = m_PaddedIntegration.data() + (row + 1) * paddedColumns + 1;
+
+		int col{};
+		for (; col + 4 <= m_Columns; col += 4)
+		{
+			//Same strict less than as the scalar path, so ties keep the first neighbour
+			__m128i lowestCost = _mm_set1_epi32(INT_MAX);
+			__m128i lowestNeighbour = _mm_set1_epi32(-1);
+			for (int i{}; i < nrOfNeighbours; i++)
+			{
+				const __m128i cost = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + col + neighbourStrides[i]));
+				const __m128i isLower = _mm_cmplt_epi32(cost, lowestCost);
+				lowestCost = _mm_or_si128(_mm_and_si128(isLower, cost), _mm_andnot_si128(isLower, lowestCost));
+				lowestNeighbour = _mm_or_si128(_mm_and_si128(isLower, _mm_set1_epi32(i)), _mm_andnot_si128(isLower, lowestNeighbour));
+			}
+
+			_mm_store_si128(reinterpret_cast<__m128i*>(lowestNeighbours), lowestNeighbour);
+			for (int lane{}; lane < 4; lane++)
+			{
+				const int idx = row * m_Columns + col + lane;
+				const bool hasDirection = idx != goalIdx && costs[idx] < m_NonTraversable && lowestNeighbours[lane] != -1;
+				directions[idx] = hasDirection ? m_NeighbourDirections[lowestNeighbours[lane]] : uint16_t(0);
+			}
+		}
+
+		//Leftover cells of the row
+		for (; col < m_Columns; col++)
+		{
+			const int idx = row * m_Columns + col;
+			if (idx == goalIdx || costs[idx] >= m_NonTraversable)
+			{
+				directions[idx] = 0;
+				continue;
+			}
+
+			int lowestCost{ INT_MAX };
+			int lowestNeighbour{ -1 };
+			for (int i{}; i < nrOfNeighbours; i++)
+			{
+				const int cost = pRow[col + neighbourStrides[i]];
+				if (cost < lowestCost)
+				{
+					lowestCost = cost;
+					lowestNeighbour = i;
+				}
+			}
+
+			directions[idx] = lowestNeighbour != -1 ? m_NeighbourDirections[lowestNeighbour] : uint16_t(0);
+		}
+	}
+#else
+	UNREFERENCED_PARAMETER(costs);
+	UNREFERENCED_PARAMETER(goalIdx);
+	UNREFERENCED_PARAMETER(directions);
+#endif
+}
+
+void FlowFieldIntegrator::PropagateDijkstra(const std::vector<uint8_t>& costs, std::vector<int>& integration, bool isRepair)
+{
+	while (!m_Heap.IsEmpty())
+	{
+		const auto entry = m_Heap.Pop();
+		const int currentIdx = entry.value;
+		const int currentCost = integration[currentIdx];
+
+		//A cheaper path to this cell was found after it was pushed
+		if (int(entry.key) != currentCost)
+			continue;
+
+		const int currentCol = currentIdx % m_Columns;
+		const int currentRow = currentIdx / m_Columns;
+
+		for (const NeighbourOffset& offset : m_Neighbours)
+		{
+			const int col = currentCol + offset.col;
+			const int row = currentRow + offset.row;
+			if (col < 0 || col >= m_Columns || row < 0 || row >= m_Rows)
+				continue;
+
+			const int nextIdx = row * m_Columns + col;
+			if (costs[nextIdx] >= m_NonTraversable)
+				continue;
+
+			const int integrationCost = currentCost + offset.cost + costs[nextIdx];
+			if (integrationCost < integration[nextIdx])
+			{
+				if (isRepair)
+					TouchRepairCell(integration, nextIdx);
+
+				integration[nextIdx] = integrationCost;
+				m_Heap.Push(static_cast<unsigned int>(integrationCost), nextIdx);
+			}
+		}
+	}
+}
+
+int FlowFieldIntegrator::GetCheapestNeighbourCost(const std::vector<uint8_t>& costs, const std::vector<int>& integration, int idx) const
+{
+	const int currentCol = idx % m_Columns;
+	const int currentRow = idx / m_Columns;
+
+	int cheapestCost = UNREACHABLE;
+	for (const NeighbourOffset& offset : m_Neighbours)
+	{
+		const int col = currentCol + offset.col;
+		const int row = currentRow + offset.row;
+		if (col < 0 || col >= m_Columns || row < 0 || row >= m_Rows)
+			continue;
+
+		const int neighbourCost = integration[row * m_Columns + col];
+		if (neighbourCost >= UNREACHABLE)
+			continue;
+
+		cheapestCost = std::min(cheapestCost, neighbourCost + offset.cost + costs[idx]);
+	}
+
+	return cheapestCost;
+}
+
+void FlowFieldIntegrator::TouchRepairCell(const std::vector<int>& integration, int idx)
+{
+	if (m_OpenStamps[idx] == m_Generation)
+		return;
+
+	m_OpenStamps[idx] = m_Generation;
+	m_RepairTouched.push_back({ idx, integration[idx] });
+}
+
+void FlowFieldIntegrator::NextGeneration()
+{
+	++m_Generation;
+
+	//Stamps wrapped around, old stamps could be mistaken for the current run
+	if (m_Generation == 0)
+	{
+		std::fill(m_OpenStamps.begin(), m_OpenStamps.end(), 0);
+		std::fill(m_ClosedStamps.begin(), m_ClosedStamps.end(), 0);
+		m_Generation = 1;
+	}
+
+	m_QueueHead = 0;
+	m_QueueCount = 0;
+}
+
+void FlowFieldIntegrator::PushQueue(int idx)
+{
+	int tail = m_QueueHead + m_QueueCount;
+	if (tail >= int(m_Queue.size()))
+		tail -= int(m_Queue.size());
+
+	m_Queue[tail] = idx;
+	++m_QueueCount;
+}
+
+int FlowFieldIntegrator::PopQueue()
+{
+	const int idx = m_Queue[m_QueueHead];
+
+	++m_QueueHead;
+	if (m_QueueHead == int(m_Queue.size()))
+		m_QueueHead = 0;
+
+	--m_QueueCount;
+	return idx;
+}
+
+float FlowFieldIntegrator::SolveEikonal(const std::vector<uint8_t>& costs, const std::vector<float>& arrivalTimes, int idx) const
+{
+	const int col = idx % m_Columns;
+	const int row = idx / m_Columns;
+
+	//Smallest known arrival time along each axis
+	auto knownTime = [this, &arrivalTimes](int neighbourIdx)
+	{
+		return m_ClosedStamps[neighbourIdx] == m_Generation ? arrivalTimes[neighbourIdx] : FLT_MAX;
+	};
+
+	float a = std::min(col > 0 ? knownTime(idx - 1) : FLT_MAX, col < m_Columns - 1 ? knownTime(idx + 1) : FLT_MAX);
+	float b = std::min(row > 0 ? knownTime(idx - m_Columns) : FLT_MAX, row < m_Rows - 1 ? knownTime(idx + m_Columns) : FLT_MAX);
+	if (a > b)
+		std::swap(a, b);
+
+	//Upwind quadratic, falls back to the one dimensional update when only one axis contributes
+	const float cost = float(costs[idx]);
+	if (b == FLT_MAX || b - a >= cost)
+		return a + cost;
+
+	const float difference = b - a;
+	return (a + b + sqrtf(2.f * cost * cost - difference * difference)) * 0.5f;
+}
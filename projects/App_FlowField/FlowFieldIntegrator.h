@@ -0,0 +1,163 @@
+#ifndef FLOWFIELD_INTEGRATOR_H
+#define FLOWFIELD_INTEGRATOR_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include <vector>
+#include "framework/EliteHelpers/ERadixHeap.h"
+#include "framework/EliteHelpers/EThreadPool.h"
+#include "FlowFieldGrid.h"
+
+//SSE2 is always there on x64 and opt-in on x86
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLOWFIELD_SSE2
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------
+// Integration Modes
+//-----------------------------------------------------------------
+enum class IntegrationMode
+{
+	BFS,		//Wavefront, exact only when all costs are equal
+	Dijkstra,	//Shortest path over weighted cost fields
+	Eikonal		//Fast marching arrival times, gives continuous directions
+};
+
+//-----------------------------------------------------------------
+// Integrator
+//-----------------------------------------------------------------
+// Computes integration fields over a flat, row-major cost array.
+// All bookkeeping (visited stamps, queue) lives in per-cell arrays that are kept
+// between runs, so a goal change costs O(N) instead of list lookups per neighbour.
+class FlowFieldIntegrator final
+{
+public:
+	//Integration cost of cells that can't reach the goal
+	static const int UNREACHABLE = 69420360; //Very carefully calculated number
+
+	//Constructor & Destructor
+	FlowFieldIntegrator(int columns, int rows, bool isConnectedDiagonally, int costStraight, int costDiagonal, int nonTraversable);
+	~FlowFieldIntegrator() = default;
+
+	//Runs the integration selected by mode, Eikonal arrival times are rounded
+	void Integrate(IntegrationMode mode, const std::vector<uint8_t>& costs, int goalIdx, std::vector<int>& integration);
+
+	//Wavefront (breadth first) integration, same visiting order and costs as the graph based BFS
+	void IntegrateBFS(const std::vector<uint8_t>& costs, int goalIdx, std::vector<int>& integration);
+
+	//Dijkstra integration using a radix heap keyed on the integer integration cost
+	void IntegrateDijkstra(const std::vector<uint8_t>& costs, int goalIdx, std::vector<int>& integration);
+
+	//Same result as IntegrateDijkstra, computed on the thread pool. The rows are split in bands and
+	//even and odd bands take turns running a local Dijkstra from their borders until nothing changes.
+	void IntegrateDijkstraParallel(const std::vector<uint8_t>& costs, int goalIdx, std::vector<int>& integration, Elite::EThreadPool& threadPool);
+
+	//Integrate() runs Dijkstra in parallel while a thread pool is set, nullptr goes back to one thread
+	void SetThreadPool(Elite::EThreadPool* pThreadPool) { m_pThreadPool = pThreadPool; }
+
+	//Dijkstra integration from several (cell, integration cost) seeds at once
+	void IntegrateDijkstra(const std::vector<uint8_t>& costs, const std::vector<std::pair<int, int>>& seeds, std::vector<int>& integration);
+
+	//Repairs a Dijkstra integration after the cost of one cell changed, costs already hold the new cost.
+	//Only cells depending on the changed cell are re-propagated, cells whose cost changed are put in changedCells.
+	//Returns false when the change can't be repaired locally and a full integration is needed.
+	bool RepairDijkstra(const std::vector<uint8_t>& costs, int goalIdx, int changedIdx, int oldCost, std::vector<int>& integration, std::vector<int>& changedCells);
+
+	//Fast marching solution of the Eikonal equation |grad T| = cost, unreachable cells get FLT_MAX
+	void IntegrateEikonal(const std::vector<uint8_t>& costs, int goalIdx, std::vector<float>& arrivalTimes);
+
+	//Normalized -grad T per cell, zero for the goal and unreachable cells
+	void CalculateGradientDirections(const std::vector<float>& arrivalTimes, std::vector<uint16_t>& directions) const;
+
+	//Per cell the direction to the neighbour with the lowest integration cost, zero for walls and the goal.
+	//Runs 4 cells at a time with SSE2 when available and enabled, both paths give the same result.
+	void CalculateNeighbourDirections(const std::vector<uint8_t>& costs, const std::vector<int>& integration, int goalIdx, std::vector<uint16_t>& directions);
+	uint16_t CalculateNeighbourDirection(const std::vector<uint8_t>& costs, const std::vector<int>& integration, int goalIdx, int idx) const;
+
+	//Per cell 1 when the straight line from its center to the goal center only crosses traversable cells, 0 otherwise.
+	//Propagated outward from the goal ring by ring per octant, keeping the slopes that no wall shadows yet.
+	//Cells that only cost more don't block the line, the crowd density raises costs all over the field.
+	void CalculateLineOfSight(const std::vector<uint8_t>& costs, int goalIdx, std::vector<uint8_t>& lineOfSight) const;
+
+	//Lets the scalar path be forced, to compare both
+	void SetUseSimd(bool useSimd) { m_UseSimd = useSimd; }
+	bool GetUseSimd() const { return m_UseSimd; }
+	static bool IsSimdSupported();
+
+	//Arrival times of the last Eikonal run through Integrate()
+	const std::vector<float>& GetArrivalTimes() const { return m_ArrivalTimes; }
+
+	int GetColumns() const { return m_Columns; }
+	int GetRows() const { return m_Rows; }
+	int GetNrOfCells() const { return m_Columns * m_Rows; }
+
+private:
+	struct NeighbourOffset
+	{
+		int col;
+		int row;
+		int cost;
+	};
+
+	//Datamembers
+	int m_Columns;
+	int m_Rows;
+	int m_NonTraversable;
+
+	//Neighbours in the order GridGraph stores its connections
+	std::vector<NeighbourOffset> m_Neighbours;
+	std::vector<uint16_t> m_NeighbourDirections;
+
+	//Integration copy with a border of INT_MAX, so the direction kernel never checks bounds
+	std::vector<int> m_PaddedIntegration;
+	bool m_UseSimd = true;
+
+	//A cell is open/closed when its stamp equals the current generation
+	std::vector<unsigned int> m_OpenStamps;
+	std::vector<unsigned int> m_ClosedStamps;
+	unsigned int m_Generation = 0;
+
+	//Ring buffer queue, every cell is pushed at most once per run
+	std::vector<int> m_Queue;
+	int m_QueueHead = 0;
+	int m_QueueCount = 0;
+
+	//Priority queue of cell indices for Dijkstra
+	Elite::ERadixHeap<int> m_Heap;
+
+	//Parallel Dijkstra, every band owns its heap and only writes its own rows
+	struct Band
+	{
+		int firstRow;
+		int endRow;
+		bool hasChanged;
+		Elite::ERadixHeap<int> heap;
+	};
+	std::vector<Band> m_Bands;
+	Elite::EThreadPool* m_pThreadPool = nullptr;
+
+	//Min heap of (arrival time, cell) for fast marching, stale entries are skipped
+	std::vector<std::pair<float, int>> m_TrialHeap;
+	std::vector<float> m_ArrivalTimes;
+
+	//Cells touched by a repair together with their integration cost before it
+	std::vector<std::pair<int, int>> m_RepairTouched;
+
+	//Functions
+	void NextGeneration();
+	void PushQueue(int idx);
+	int PopQueue();
+	int GetCheapestNeighbourCost(const std::vector<uint8_t>& costs, const std::vector<int>& integration, int idx) const;
+	void TouchRepairCell(const std::vector<int>& integration, int idx);
+	void PropagateDijkstra(const std::vector<uint8_t>& costs, std::vector<int>& integration, bool isRepair);
+	void RelaxBand(const std::vector<uint8_t>& costs, int goalIdx, std::vector<int>& integration, Band& band, bool isFirstPass) const;
+	float SolveEikonal(const std::vector<uint8_t>& costs, const std::vector<float>& arrivalTimes, int idx) const;
+	void PadIntegration(const std::vector<int>& integration);
+	void CalculateNeighbourDirectionsSimd(const std::vector<uint8_t>& costs, int goalIdx, std::vector<uint16_t>& directions) const;
+
+	//C++ make the class non-copyable
+	FlowFieldIntegrator(const FlowFieldIntegrator&) = delete;
+	FlowFieldIntegrator& operator=(const FlowFieldIntegrator&) = delete;
+};
+#endif
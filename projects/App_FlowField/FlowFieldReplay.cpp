@@ -0,0 +1,116 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include <iomanip>
+#include "FlowFieldReplay.h"
+
+namespace
+{
+	const char* const REPLAY_VERSION{ "FlowFieldReplay 1" };
+	const char* const EVENT_NAMES[]{ "goal", "wall", "retarget" };
+}
+
+//Functions
+void FlowFieldReplay::StartRecording(unsigned int seed, float timeStep, int nrOfAgents)
+{
+	m_Seed = seed;
+	m_TimeStep = timeStep;
+	m_NrOfAgents = nrOfAgents;
+	m_NrOfFrames = 0;
+	m_InputEvents.clear();
+	m_Retargets.clear();
+}
+
+void FlowFieldReplay::Record(const ReplayEvent& event)
+{
+	if (event.type == ReplayEventType::Retarget)
+		m_Retargets.push_back(event);
+	else
+		m_InputEvents.push_back(event);
+}
+
+bool FlowFieldReplay::Save(const std::string& path, int nrOfFrames)
+{
+	m_NrOfFrames = nrOfFrames;
+
+	std::ofstream file{ path };
+	if (!file)
+		return false;
+
+	//Timestep with enough digits to read back the exact same float
+	file << REPLAY_VERSION << '\n';
+	file << "seed " << m_Seed << '\n';
+	file << "step " << std::setprecision(9) << m_TimeStep << '\n';
+	file << "agents " << m_NrOfAgents << '\n';
+	file << "frames " << m_NrOfFrames << '\n';
+
+	//Input of a frame is applied before the simulation picks new goals in it
+	size_t inputIdx{}, retargetIdx{};
+	while (inputIdx < m_InputEvents.size() || retargetIdx < m_Retargets.size())
+	{
+		const bool isInput{ retargetIdx == m_Retargets.size()
+			|| (inputIdx < m_InputEvents.size() && m_InputEvents[inputIdx].frame <= m_Retargets[retargetIdx].frame) };
+		const ReplayEvent& event = isInput ? m_InputEvents[inputIdx++] : m_Retargets[retargetIdx++];
+
+		file << EVENT_NAMES[int(event.type)] << ' ' << event.frame << ' ' << event.groupId << ' ' << event.cellIdx << '\n';
+	}
+
+	return bool(file);
+}
+
+bool FlowFieldReplay::Load(const std::string& path)
+{
+	std::ifstream file{ path };
+	std::string line{};
+	if (!std::getline(file, line) || line != REPLAY_VERSION)
+		return false;
+
+	std::string name{};
+	if (!(file >> name >> m_Seed) || name != "seed"
+		|| !(file >> name >> m_TimeStep) || name != "step"
+		|| !(file >> name >> m_NrOfAgents) || name != "agents"
+		|| !(file >> name >> m_NrOfFrames) || name != "frames")
+		return false;
+
+	m_InputEvents.clear();
+	m_Retargets.clear();
+	m_NextInputEvent = 0;
+	m_NextRetarget = 0;
+	m_NrOfMismatches = 0;
+
+	ReplayEvent event{};
+	while (file >> name >> event.frame >> event.groupId >> event.cellIdx)
+	{
+		const auto nameIt = std::find(std::begin(EVENT_NAMES), std::end(EVENT_NAMES), name);
+		if (nameIt == std::end(EVENT_NAMES))
+			return false;
+
+		event.type = ReplayEventType(nameIt - std::begin(EVENT_NAMES));
+		Record(event);
+	}
+
+	return file.eof();
+}
+
+bool FlowFieldReplay::PopInputEvent(int frame, ReplayEvent& event)
+{
+	if (m_NextInputEvent == m_InputEvents.size() || m_InputEvents[m_NextInputEvent].frame > frame)
+		return false;
+
+	event = m_InputEvents[m_NextInputEvent++];
+	return true;
+}
+
+void FlowFieldReplay::CheckRetarget(const ReplayEvent& event)
+{
+	if (m_NextRetarget == m_Retargets.size())
+	{
+		++m_NrOfMismatches;
+		return;
+	}
+
+	const ReplayEvent& expected = m_Retargets[m_NextRetarget++];
+	if (expected.frame != event.frame || expected.groupId != event.groupId || expected.cellIdx != event.cellIdx)
+		++m_NrOfMismatches;
+}
@@ -0,0 +1,76 @@
+#ifndef FLOWFIELD_REPLAY_H
+#define FLOWFIELD_REPLAY_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------
+// Replay Events
+//-----------------------------------------------------------------
+enum class ReplayEventType
+{
+	Goal,		//Goal picked with the mouse
+	Wall,		//Wall placed with the mouse
+	Retarget	//Goal picked by the simulation, only used to check a replay didn't drift
+};
+
+struct ReplayEvent
+{
+	int frame;
+	ReplayEventType type;
+	int groupId;
+	int cellIdx;
+};
+
+//-----------------------------------------------------------------
+// Replay
+//-----------------------------------------------------------------
+// Input of a deterministic run, stored as a small text file: a header with the seed, timestep and
+// number of agents, then one line per event. Playing it back with the same seed and timestep gives
+// the same simulation, the recorded retargets are compared on the way to catch any divergence.
+class FlowFieldReplay final
+{
+public:
+	//Constructor & Destructor
+	FlowFieldReplay() = default;
+	~FlowFieldReplay() = default;
+
+	//Recording
+	void StartRecording(unsigned int seed, float timeStep, int nrOfAgents);
+	void Record(const ReplayEvent& event);
+	bool Save(const std::string& path, int nrOfFrames);
+
+	//Playback, events have to be asked for frame by frame
+	bool Load(const std::string& path);
+	bool PopInputEvent(int frame, ReplayEvent& event);
+	void CheckRetarget(const ReplayEvent& event);
+	bool IsFinished(int frame) const { return frame >= m_NrOfFrames; }
+
+	unsigned int GetSeed() const { return m_Seed; }
+	float GetTimeStep() const { return m_TimeStep; }
+	int GetNrOfAgents() const { return m_NrOfAgents; }
+	int GetNrOfFrames() const { return m_NrOfFrames; }
+	int GetNrOfEvents() const { return int(m_InputEvents.size() + m_Retargets.size()); }
+	int GetNrOfMismatches() const { return m_NrOfMismatches; }
+
+private:
+	//Datamembers
+	unsigned int m_Seed = 0;
+	float m_TimeStep = 0.f;
+	int m_NrOfAgents = 0;
+	int m_NrOfFrames = 0;
+
+	//Goals and walls from the mouse are replayed, retargets are only compared
+	std::vector<ReplayEvent> m_InputEvents;
+	std::vector<ReplayEvent> m_Retargets;
+	size_t m_NextInputEvent = 0;
+	size_t m_NextRetarget = 0;
+	int m_NrOfMismatches = 0;
+
+	//C++ make the class non-copyable
+	FlowFieldReplay(const FlowFieldReplay&) = delete;
+	FlowFieldReplay& operator=(const FlowFieldReplay&) = delete;
+};
+#endif
@@ -0,0 +1,383 @@
+//Precompiled Header [ALWAYS ON TOP IN CPP]
+#include "stdafx.h"
+
+//Includes
+#include "FlowFieldSectorMap.h"
+
+namespace
+{
+	//Neighbour order used by FlowFieldIntegrator, so ties resolve the same way
+	const int NEIGHBOUR_OFFSETS[8][2]{ { -1, -1 }, { 0, -1 }, { 1, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 }, { -1, 1 } };
+}
+
+//Constructor & Destructor
+FlowFieldSectorMap::FlowFieldSectorMap(int columns, int rows, int sectorSize, bool isConnectedDiagonally, int costStraight, int costDiagonal, int nonTraversable)
+	: m_Columns(columns)
+	, m_Rows(rows)
+	, m_SectorSize(sectorSize)
+	, m_SectorColumns((columns + sectorSize - 1) / sectorSize)
+	, m_SectorRows((rows + sectorSize - 1) / sectorSize)
+	, m_CostStraight(costStraight)
+	, m_CostDiagonal(costDiagonal)
+	, m_NonTraversable(nonTraversable)
+	, m_IsConnectedDiagonally(isConnectedDiagonally)
+{
+	m_pSectorIntegrator = new FlowFieldIntegrator(sectorSize, sectorSize, isConnectedDiagonally, costStraight, costDiagonal, nonTraversable);
+	m_SectorCosts.resize(sectorSize * sectorSize);
+	m_SectorPortals.resize(GetNrOfSectors());
+	m_SectorFields.resize(GetNrOfSectors());
+}
+
+FlowFieldSectorMap::~FlowFieldSectorMap()
+{
+	SAFE_DELETE(m_pSectorIntegrator);
+}
+
+//Functions
+void FlowFieldSectorMap::BuildPortals(const std::vector<uint8_t>& costs)
+{
+	m_pCosts = &costs;
+
+	m_Portals.clear();
+	m_PortalEdges.clear();
+	m_PortalAtCell.clear();
+	for (auto& sectorPortals : m_SectorPortals)
+		sectorPortals.clear();
+
+	//Vertical borders, every run of cells open on both sides becomes one portal
+	for (int sectorCol{ 1 }; sectorCol < m_SectorColumns; sectorCol++)
+	{
+		const int col = sectorCol * m_SectorSize;
+		for (int sectorRow{}; sectorRow < m_SectorRows; sectorRow++)
+		{
+			const int firstRow = sectorRow * m_SectorSize;
+			const int endRow = std::min(firstRow + m_SectorSize, m_Rows);
+
+			int runStart{ -1 };
+			for (int row{ firstRow }; row <= endRow; row++)
+			{
+				const bool isOpen = row < endRow && IsTraversable(row * m_Columns + col - 1) && IsTraversable(row * m_Columns + col);
+				if (row < endRow)
+					AddDiagonalPortals(row * m_Columns + col - 1, row * m_Columns + col, m_Columns);
+
+				if (isOpen && runStart == -1)
+				{
+					runStart = row;
+				}
+				else if (!isOpen && runStart != -1)
+				{
+					AddPortalRun(runStart * m_Columns + col - 1, runStart * m_Columns + col, row - runStart, m_Columns);
+					runStart = -1;
+				}
+			}
+		}
+	}
+
+	//Horizontal borders
+	for (int sectorRow{ 1 }; sectorRow < m_SectorRows; sectorRow++)
+	{
+		const int row = sectorRow * m_SectorSize;
+		for (int sectorCol{}; sectorCol < m_SectorColumns; sectorCol++)
+		{
+			const int firstCol = sectorCol * m_SectorSize;
+			const int endCol = std::min(firstCol + m_SectorSize, m_Columns);
+
+			int runStart{ -1 };
+			for (int col{ firstCol }; col <= endCol; col++)
+			{
+				const bool isOpen = col < endCol && IsTraversable((row - 1) * m_Columns + col) && IsTraversable(row * m_Columns + col);
+				if (col < endCol)
+					AddDiagonalPortals((row - 1) * m_Columns + col, row * m_Columns + col, 1);
+
+				if (isOpen && runStart == -1)
+				{
+					runStart = col;
+				}
+				else if (!isOpen && runStart != -1)
+				{
+					AddPortalRun((row - 1) * m_Columns + runStart, row * m_Columns + runStart, col - runStart, 1);
+					runStart = -1;
+				}
+			}
+		}
+	}
+
+	//Costs between the portals of the same sector
+	for (int sectorIdx{}; sectorIdx < GetNrOfSectors(); sectorIdx++)
+	{
+		const auto& sectorPortals = m_SectorPortals[sectorIdx];
+		for (int portalIdx : sectorPortals)
+		{
+			m_SectorSeeds.clear();
+			m_SectorSeeds.push_back({ GetSectorCellIdx(sectorIdx, m_Portals[portalIdx].cellIdx), 0 });
+			IntegrateSector(sectorIdx);
+
+			for (int otherPortalIdx : sectorPortals)
+			{
+				const int cost = m_SectorIntegration[GetSectorCellIdx(sectorIdx, m_Portals[otherPortalIdx].cellIdx)];
+				if (otherPortalIdx != portalIdx && cost < FlowFieldIntegrator::UNREACHABLE)
+					m_PortalEdges[portalIdx].push_back({ otherPortalIdx, cost });
+			}
+		}
+	}
+
+	SetGoal(m_GoalIdx);
+}
+
+void FlowFieldSectorMap::SetGoal(int goalIdx)
+{
+	m_GoalIdx = goalIdx;
+	m_PortalCosts.assign(m_Portals.size(), FlowFieldIntegrator::UNREACHABLE);
+
+	for (auto& sectorField : m_SectorFields)
+		sectorField.isBuilt = false;
+
+	if (!m_pCosts || goalIdx < 0 || goalIdx >= m_Columns * m_Rows)
+		return;
+
+	//Costs from the goal to the portals of its own sector
+	const int goalSectorIdx = GetSectorIdx(goalIdx);
+	m_SectorSeeds.clear();
+	m_SectorSeeds.push_back({ GetSectorCellIdx(goalSectorIdx, goalIdx), 0 });
+	IntegrateSector(goalSectorIdx);
+
+	m_PortalHeap.Clear();
+	for (int portalIdx : m_SectorPortals[goalSectorIdx])
+	{
+		const int cost = m_SectorIntegration[GetSectorCellIdx(goalSectorIdx, m_Portals[portalIdx].cellIdx)];
+		if (cost < FlowFieldIntegrator::UNREACHABLE)
+		{
+			m_PortalCosts[portalIdx] = cost;
+			m_PortalHeap.Push(static_cast<unsigned int>(cost), portalIdx);
+		}
+	}
+
+	//Dijkstra over the portal graph
+	while (!m_PortalHeap.IsEmpty())
+	{
+		const auto entry = m_PortalHeap.Pop();
+		const int portalIdx = entry.value;
+		const int portalCost = m_PortalCosts[portalIdx];
+		if (int(entry.key) != portalCost)
+			continue;
+
+		for (const PortalEdge& edge : m_PortalEdges[portalIdx])
+		{
+			const int cost = portalCost + edge.cost;
+			if (cost < m_PortalCosts[edge.toPortal])
+			{
+				m_PortalCosts[edge.toPortal] = cost;
+				m_PortalHeap.Push(static_cast<unsigned int>(cost), edge.toPortal);
+			}
+		}
+	}
+}
+
+Elite::Vector2 FlowFieldSectorMap::GetDirection(int cellIdx)
+{
+	const int sectorIdx = GetSectorIdx(cellIdx);
+	BuildSector(sectorIdx);
+
+	return FlowFieldGrid::UnpackDirection(m_SectorFields[sectorIdx].directions[GetSectorCellIdx(sectorIdx, cellIdx)]);
+}
+
+void FlowFieldSectorMap::BuildSector(int sectorIdx)
+{
+	if (!m_SectorFields[sectorIdx].isBuilt)
+		BuildSectorField(sectorIdx);
+}
+
+Elite::Vector2 FlowFieldSectorMap::GetBuiltDirection(int cellIdx) const
+{
+	const int sectorIdx = GetSectorIdx(cellIdx);
+	if (!m_SectorFields[sectorIdx].isBuilt)
+		return Elite::ZeroVector2;
+
+	return FlowFieldGrid::UnpackDirection(m_SectorFields[sectorIdx].directions[GetSectorCellIdx(sectorIdx, cellIdx)]);
+}
+
+int FlowFieldSectorMap::GetBuiltIntegration(int cellIdx) const
+{
+	const int sectorIdx = GetSectorIdx(cellIdx);
+	if (!m_SectorFields[sectorIdx].isBuilt)
+		return -1;
+
+	return m_SectorFields[sectorIdx].integration[GetSectorCellIdx(sectorIdx, cellIdx)];
+}
+
+int FlowFieldSectorMap::GetSectorIdx(int cellIdx) const
+{
+	const int col = cellIdx % m_Columns;
+	const int row = cellIdx / m_Columns;
+
+	return (row / m_SectorSize) * m_SectorColumns + col / m_SectorSize;
+}
+
+int FlowFieldSectorMap::GetNrOfBuiltSectors() const
+{
+	int count{};
+	for (const auto& sectorField : m_SectorFields)
+	{
+		if (sectorField.isBuilt)
+			++count;
+	}
+
+	return count;
+}
+
+void FlowFieldSectorMap::AddPortal(int cellIdx, int otherCellIdx, int stepCost)
+{
+	//A cell on a sector corner can be a portal towards two sectors, it keeps a single node
+	int portalIndices[2]{};
+	const int cellIndices[2]{ cellIdx, otherCellIdx };
+	for (int i{}; i < 2; i++)
+	{
+		auto it = m_PortalAtCell.find(cellIndices[i]);
+		if (it != m_PortalAtCell.end())
+		{
+			portalIndices[i] = it->second;
+			continue;
+		}
+
+		portalIndices[i] = int(m_Portals.size());
+		m_Portals.push_back({ cellIndices[i], GetSectorIdx(cellIndices[i]) });
+		m_PortalEdges.push_back({});
+		m_PortalAtCell[cellIndices[i]] = portalIndices[i];
+		m_SectorPortals[m_Portals.back().sectorIdx].push_back(portalIndices[i]);
+	}
+
+	//Crossing the border costs the step plus the cost of the cell that is entered, like a step in the integrator
+	m_PortalEdges[portalIndices[0]].push_back({ portalIndices[1], stepCost + (*m_pCosts)[cellIndices[1]] });
+	m_PortalEdges[portalIndices[1]].push_back({ portalIndices[0], stepCost + (*m_pCosts)[cellIndices[0]] });
+}
+
+void FlowFieldSectorMap::AddPortalRun(int firstCellIdx, int otherFirstCellIdx, int runLength, int step)
+{
+	//The middle of the run represents the whole run
+	const int offset = (runLength / 2) * step;
+	AddPortal(firstCellIdx + offset, otherFirstCellIdx + offset, m_CostStraight);
+}
+
+void FlowFieldSectorMap::AddDiagonalPortals(int cellIdx, int otherCellIdx, int step)
+{
+	//Diagonal steps over the border only get a portal when no straight crossing runs next to them.
+	//step walks along the border: 1 on horizontal borders, the number of columns on vertical ones.
+	if (!m_IsConnectedDiagonally || !IsTraversable(cellIdx) || IsTraversable(otherCellIdx))
+		return;
+
+	const int col = cellIdx % m_Columns;
+	const int row = cellIdx / m_Columns;
+	for (int direction{ -1 }; direction <= 1; direction += 2)
+	{
+		const int alongCol = step == 1 ? col + direction : col;
+		const int alongRow = step == 1 ? row : row + direction;
+		if (alongCol < 0 || alongCol >= m_Columns || alongRow < 0 || alongRow >= m_Rows)
+			continue;
+
+		//Steps over a sector corner are already found on the vertical border
+		if (step == 1 && alongCol / m_SectorSize != col / m_SectorSize)
+			continue;
+
+		const int alongOffset = direction * step;
+		if (IsTraversable(otherCellIdx + alongOffset) && !IsTraversable(cellIdx + alongOffset))
+			AddPortal(cellIdx, otherCellIdx + alongOffset, m_CostDiagonal);
+	}
+}
+
+void FlowFieldSectorMap::IntegrateSector(int sectorIdx)
+{
+	for (int sectorCellIdx{}; sectorCellIdx < int(m_SectorCosts.size()); sectorCellIdx++)
+	{
+		const int cellIdx = GetCellIdx(sectorIdx, sectorCellIdx);
+		m_SectorCosts[sectorCellIdx] = cellIdx != -1 ? (*m_pCosts)[cellIdx] : uint8_t(m_NonTraversable);
+	}
+
+	m_pSectorIntegrator->IntegrateDijkstra(m_SectorCosts, m_SectorSeeds, m_SectorIntegration);
+}
+
+void FlowFieldSectorMap::BuildSectorField(int sectorIdx)
+{
+	SectorField& sectorField = m_SectorFields[sectorIdx];
+	sectorField.directions.assign(m_SectorSize * m_SectorSize, 0);
+	sectorField.isBuilt = true;
+
+	if (!m_pCosts || m_GoalIdx < 0)
+		return;
+
+	//Seed with the goal and the portals, portals carry their cost to the goal
+	m_SectorSeeds.clear();
+	if (GetSectorIdx(m_GoalIdx) == sectorIdx)
+		m_SectorSeeds.push_back({ GetSectorCellIdx(sectorIdx, m_GoalIdx), 0 });
+
+	for (int portalIdx : m_SectorPortals[sectorIdx])
+	{
+		if (m_PortalCosts[portalIdx] < FlowFieldIntegrator::UNREACHABLE)
+			m_SectorSeeds.push_back({ GetSectorCellIdx(sectorIdx, m_Portals[portalIdx].cellIdx), m_PortalCosts[portalIdx] });
+	}
+
+	IntegrateSector(sectorIdx);
+	sectorField.integration = m_SectorIntegration;
+
+	//Point every cell at its cheapest neighbour, portals of neighbouring sectors are visible across the border
+	for (int sectorCellIdx{}; sectorCellIdx < m_SectorSize * m_SectorSize; sectorCellIdx++)
+	{
+		const int cellIdx = GetCellIdx(sectorIdx, sectorCellIdx);
+		if (cellIdx == -1 || cellIdx == m_GoalIdx || !IsTraversable(cellIdx))
+			continue;
+
+		const int col = cellIdx % m_Columns;
+		const int row = cellIdx / m_Columns;
+
+		int lowestCost{ FlowFieldIntegrator::UNREACHABLE };
+		uint16_t direction{};
+		for (const auto& offset : NEIGHBOUR_OFFSETS)
+		{
+			if (!m_IsConnectedDiagonally && offset[0] != 0 && offset[1] != 0)
+				continue;
+
+			const int neighbourCol = col + offset[0];
+			const int neighbourRow = row + offset[1];
+			if (neighbourCol < 0 || neighbourCol >= m_Columns || neighbourRow < 0 || neighbourRow >= m_Rows)
+				continue;
+
+			const int neighbourIdx = neighbourRow * m_Columns + neighbourCol;
+			int cost{ FlowFieldIntegrator::UNREACHABLE };
+			if (GetSectorIdx(neighbourIdx) == sectorIdx)
+			{
+				cost = sectorField.integration[GetSectorCellIdx(sectorIdx, neighbourIdx)];
+			}
+			else
+			{
+				auto it = m_PortalAtCell.find(neighbourIdx);
+				if (it != m_PortalAtCell.end())
+					cost = m_PortalCosts[it->second];
+			}
+
+			if (cost < lowestCost)
+			{
+				lowestCost = cost;
+				direction = FlowFieldGrid::PackDirection(Elite::Vector2{ float(offset[0]), float(offset[1]) }.GetNormalized());
+			}
+		}
+
+		sectorField.directions[sectorCellIdx] = direction;
+	}
+}
+
+int FlowFieldSectorMap::GetSectorCellIdx(int sectorIdx, int cellIdx) const
+{
+	const int col = cellIdx % m_Columns - (sectorIdx % m_SectorColumns) * m_SectorSize;
+	const int row = cellIdx / m_Columns - (sectorIdx / m_SectorColumns) * m_SectorSize;
+
+	return row * m_SectorSize + col;
+}
+
+int FlowFieldSectorMap::GetCellIdx(int sectorIdx, int sectorCellIdx) const
+{
+	const int col = (sectorIdx % m_SectorColumns) * m_SectorSize + sectorCellIdx % m_SectorSize;
+	const int row = (sectorIdx / m_SectorColumns) * m_SectorSize + sectorCellIdx / m_SectorSize;
+	if (col >= m_Columns || row >= m_Rows)
+		return -1;
+
+	return row * m_Columns + col;
+}
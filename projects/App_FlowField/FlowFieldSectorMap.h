@@ -0,0 +1,114 @@
+#ifndef FLOWFIELD_SECTORMAP_H
+#define FLOWFIELD_SECTORMAP_H
+//-----------------------------------------------------------------
+// Includes & Forward Declarations
+//-----------------------------------------------------------------
+#include <vector>
+#include <unordered_map>
+#include "FlowFieldIntegrator.h"
+#include "FlowFieldGrid.h"
+
+//-----------------------------------------------------------------
+// Sector Map
+//-----------------------------------------------------------------
+// Hierarchical flow field: the grid is split in square sectors and every run of
+// open cells on a sector border becomes a portal. A goal change only runs a search
+// over the portal graph, the flow field of a sector is built the first time a
+// direction inside it is asked for.
+class FlowFieldSectorMap final
+{
+public:
+	//Constructor & Destructor
+	FlowFieldSectorMap(int columns, int rows, int sectorSize, bool isConnectedDiagonally, int costStraight, int costDiagonal, int nonTraversable);
+	~FlowFieldSectorMap();
+
+	//Finds the portals and the costs between portals of the same sector, needed after every cost change.
+	//The cost field is not copied and has to stay alive while the map is used.
+	void BuildPortals(const std::vector<uint8_t>& costs);
+
+	//Coarse search from the goal over the portal graph, drops all sector flow fields
+	void SetGoal(int goalIdx);
+
+	//Direction of a cell, builds the flow field of its sector when needed
+	Elite::Vector2 GetDirection(int cellIdx);
+	//Builds the flow field of a sector when it isn't built yet
+	void BuildSector(int sectorIdx);
+	//Direction of a cell when its sector is already built, zero otherwise
+	Elite::Vector2 GetBuiltDirection(int cellIdx) const;
+	//Cost to the goal of a cell when its sector is already built, -1 otherwise
+	int GetBuiltIntegration(int cellIdx) const;
+
+	int GetSectorIdx(int cellIdx) const;
+	bool IsSectorBuilt(int sectorIdx) const { return m_SectorFields[sectorIdx].isBuilt; }
+	int GetNrOfSectors() const { return m_SectorColumns * m_SectorRows; }
+	int GetNrOfBuiltSectors() const;
+
+	int GetNrOfPortals() const { return int(m_Portals.size()); }
+	int GetPortalCell(int portalIdx) const { return m_Portals[portalIdx].cellIdx; }
+
+private:
+	struct Portal
+	{
+		int cellIdx;
+		int sectorIdx;
+	};
+
+	struct PortalEdge
+	{
+		int toPortal;
+		int cost;
+	};
+
+	struct SectorField
+	{
+		bool isBuilt = false;
+		std::vector<int> integration;
+		std::vector<uint16_t> directions;
+	};
+
+	//Datamembers
+	int m_Columns;
+	int m_Rows;
+	int m_SectorSize;
+	int m_SectorColumns;
+	int m_SectorRows;
+	int m_CostStraight;
+	int m_CostDiagonal;
+	int m_NonTraversable;
+	bool m_IsConnectedDiagonally;
+	int m_GoalIdx = -1;
+
+	const std::vector<uint8_t>* m_pCosts = nullptr;
+
+	//Portal graph, edges are stored from the portal closer to the goal to the one further away
+	std::vector<Portal> m_Portals;
+	std::vector<std::vector<PortalEdge>> m_PortalEdges;
+	std::vector<std::vector<int>> m_SectorPortals;
+	std::unordered_map<int, int> m_PortalAtCell;
+	std::vector<int> m_PortalCosts;
+	Elite::ERadixHeap<int> m_PortalHeap;
+
+	std::vector<SectorField> m_SectorFields;
+
+	//Scratch for integrating a single sector, cells outside the grid are padded as walls
+	FlowFieldIntegrator* m_pSectorIntegrator = nullptr;
+	std::vector<uint8_t> m_SectorCosts;
+	std::vector<int> m_SectorIntegration;
+	std::vector<std::pair<int, int>> m_SectorSeeds;
+
+	//Functions
+	void AddPortal(int cellIdx, int otherCellIdx, int stepCost);
+	void AddDiagonalPortals(int cellIdx, int otherCellIdx, int step);
+	void AddPortalRun(int firstCellIdx, int otherFirstCellIdx, int runLength, int step);
+	void IntegrateSector(int sectorIdx);
+	void BuildSectorField(int sectorIdx);
+
+	int GetSectorCellIdx(int sectorIdx, int cellIdx) const;
+	int GetCellIdx(int sectorIdx, int sectorCellIdx) const;
+	bool IsTraversable(int cellIdx) const { return (*m_pCosts)[cellIdx] < m_NonTraversable; }
+
+	//C++ make the class non-copyable
+	FlowFieldSectorMap(const FlowFieldSectorMap&) = delete;
+	FlowFieldSectorMap& operator=(const FlowFieldSectorMap&) = delete;
+};
+#endif